@@ -0,0 +1,177 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file lowest.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ *
+ * Sample bot plugin, straight drops scored by the same four features as the built in bot.
+ *     gcc -shared -fPIC -O3 bots/lowest.c -o bots/lowest.so
+ *     ./tetris --bot ./bots/lowest.so
+ */
+
+#include <string.h>
+#include "../src/tetris_bot.h"
+
+#define MAX_ROWS                        32
+
+static int _collide(const struct tetris_bot_view_t *v, const uint16_t *rows, int dir, int x, int y)
+{
+    const uint16_t *m = v->block_rows[v->type][dir];
+    int i;
+
+    for (i = 0; i < 4; i ++)
+    {
+        uint32_t r = m[i];
+        if (r == 0)
+        {
+            continue;
+        }
+
+        if (y + i < 0 || y + i >= v->height)
+        {
+            return 1;
+        }
+
+        if (x < 0)
+        {
+            if (r & ((1u << -x) - 1))
+            {
+                return 1;
+            }
+
+            r >>= -x;
+        }
+        else
+        {
+            r <<= x;
+        }
+
+        if ((r >> v->width) || (rows[y + i] & r))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static float _score(const struct tetris_bot_view_t *v, int dir, int x, int y)
+{
+    uint16_t rows[MAX_ROWS];
+    const uint16_t *m = v->block_rows[v->type][dir];
+    uint16_t full = (1u << v->width) - 1;
+    int heights[16];
+    int i, j, n = 0, lines = 0, cells = 0, holes = 0, bump = 0, aggregate = 0;
+
+    for (i = 0; i < v->height; i ++)
+    {
+        uint16_t r = v->rows[i];
+        if (i >= y && i < y + 4)
+        {
+            r |= (x < 0) ? (m[i - y] >> -x) : (m[i - y] << x);
+        }
+
+        if (r == full)
+        {
+            lines ++;
+
+            continue;
+        }
+
+        rows[n ++] = r;
+    }
+
+    for (j = 0; j < v->width; j ++)
+    {
+        heights[j] = 0;
+        for (i = 0; i < n; i ++)
+        {
+            if ((rows[i] >> j) & 1)
+            {
+                heights[j] = i + 1;
+                cells ++;
+            }
+        }
+
+        aggregate += heights[j];
+        if (j > 0)
+        {
+            bump += (heights[j] > heights[j - 1]) ? heights[j] - heights[j - 1] : heights[j - 1] - heights[j];
+        }
+    }
+
+    holes = aggregate - cells;
+
+    return -0.51f * aggregate - 0.36f * holes - 0.18f * bump + 0.76f * lines;
+}
+
+uint32_t tetris_bot_abi(void)
+{
+    return TETRIS_BOT_ABI;
+}
+
+int tetris_bot_choose(void *state, const struct tetris_bot_view_t *v, struct tetris_bot_move_t *move)
+{
+    float best = 0, s;
+    int dir, x, y, found = 0;
+
+    if (v->height > MAX_ROWS)
+    {
+        return -1;
+    }
+
+    for (dir = 0; dir < 4; dir ++)
+    {
+        for (x = -3; x < v->width; x ++)
+        {
+            if (_collide(v, v->rows, dir, x, v->spawn_y))
+            {
+                continue;
+            }
+
+            for (y = v->spawn_y; !_collide(v, v->rows, dir, x, y - 1); y --);
+            s = _score(v, dir, x, y);
+            if (!found || s > best)
+            {
+                best = s;
+                move->x = x;
+                move->y = y;
+                move->dir = dir;
+                found = 1;
+            }
+        }
+    }
+
+    return found ? 0 : -1;
+}
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
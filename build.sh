@@ -1,3 +1,14 @@
 #!/bin/sh
 
-gcc src/*.c -O3 -lncurses -lrt -o tetris
+ENGINE=`ls src/*.c | grep -v src/tetris.c`
+
+gcc src/*.c -O3 $CFLAGS -lncurses -lrt -lpthread -ldl -lz -o tetris
+gcc tools/tune.c $ENGINE -O3 $CFLAGS -lm -lpthread -ldl -lz -o tetris-tune
+gcc tools/verify.c $ENGINE -O3 $CFLAGS -lpthread -ldl -lz -o tetris-verify
+gcc tools/corpus.c $ENGINE -O3 $CFLAGS -lpthread -ldl -lz -o tetris-corpus
+gcc tools/versus.c $ENGINE -O3 $CFLAGS -lpthread -ldl -lz -o tetris-versus
+gcc tools/tournament.c $ENGINE -O3 $CFLAGS -lm -lpthread -ldl -lz -o tetris-tournament
+gcc tools/evlog.c $ENGINE -O3 $CFLAGS -lpthread -ldl -lz -o tetris-evlog
+gcc tools/shm.c -O3 $CFLAGS -lrt -o tetris-shm
+gcc bots/lowest.c -O3 $CFLAGS -shared -fPIC -o bots/lowest.so
+gcc $ENGINE -O3 $CFLAGS -shared -fPIC -lpthread -ldl -lz -o libtetris.so
@@ -61,96 +61,20 @@ int tile_block(enum block_type_e type, enum block_direction_e dir)
     return ret;
 }
 
-BLOCK * new_block()
+void new_block(BLOCK *b, int type, int color)
 {
-    BLOCK *b = malloc(sizeof(BLOCK));
     memset(b, 0, sizeof(BLOCK));
-    b->type = (get_random() % 7) + 1;
-    b->color = (get_random() % 6) + 25;
+    b->type = type;
+    b->color = color;
     b->direction = BLOCK_DIR_0;
     b->pos.x = (PLAYGROUND_WIDTH - 4) / 2;
     b->pos.y = 0;
     b->tile = tile_block(b->type, b->direction);
     b->dropped = FALSE;
 
-    return b;
-}
-
-void del_block(BLOCK *b)
-{
-    if (b != NULL)
-    {
-        free(b);
-    }
-
-    b = NULL;
-    
     return;
 }
 
-// Try rotate block
-int try_rotate_block(BLOCK *b, bool clockwise, enum block_direction_e *dir)
-{
-    if (b == NULL)
-    {
-        return 0;
-    }
-
-    int m_dir = (int)b->direction;
-    if (clockwise)
-    {
-        if (m_dir >= BLOCK_DIR_270)
-        {
-            m_dir = BLOCK_DIR_0;
-        }
-        else
-        {
-            m_dir ++;
-        }
-    }
-    else
-    {
-        if (m_dir <= BLOCK_DIR_0)
-        {
-            m_dir = BLOCK_DIR_270;
-        }
-        else
-        {
-            m_dir --;
-        }
-    }
-
-    int m_tile = tile_block(b->type, m_dir);
-    *dir = m_dir;
-
-    return m_tile;
-}
-
-// Check solid
-bool check_block_solid(BLOCK *b, int m_tile, int off_y, int off_x, int y, int x)
-{
-    if (b == NULL)
-    {
-        return FALSE;
-    }
-
-    int tx = x - (b->pos.x + off_x);
-    int ty = y - (b->pos.y + off_y);
-    if (ty < 0 || ty > 3 || tx < 0 || tx > 3)
-    {
-        return FALSE;
-    }
-
-    if (0 == m_tile)
-    {
-        return (1 << (ty * 4 + (3 - tx)) & b->tile) > 0;
-    }
-    else
-    {
-        return (1 << (ty * 4 + (3 - tx)) & m_tile) > 0;
-    }
-}
-
 /*
  * Local variables:
  * tab-width: 4
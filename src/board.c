@@ -0,0 +1,330 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file board.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include "tetris.h"
+
+// Rows beyond playground are solid, walls padded into bit 0-3 and 20-31
+#define BOARD_WALLS                     (~(((uint32_t)0xFFFF) << BOARD_PAD))
+
+uint16_t block_rows[8][4][4];
+
+// Sideways kick offsets by type, direction before rotation and sense (0 counter clockwise, 1 clockwise)
+static signed char block_kicks[8][4][2][BOARD_KICKS];
+static int block_kick_count[8];
+
+int tile_block(enum block_type_e, enum block_direction_e);
+
+// Twice the column center of a rotation's cells
+static int _board_center(int type, int dir)
+{
+    uint16_t cols = 0;
+    int i, lo = 0, hi = 3;
+    for (i = 0; i < 4; i ++)
+    {
+        cols |= block_rows[type][dir][i];
+    }
+
+    while (lo < 3 && 0 == (cols & (1 << lo)))
+    {
+        lo ++;
+    }
+
+    while (hi > 0 && 0 == (cols & (1 << hi)))
+    {
+        hi --;
+    }
+
+    return lo + hi;
+}
+
+/*
+ * Kicks are tried in order after the plain rotation. Several tiles turn
+ * about an off-center pivot, so the first kick leans back the way the cells
+ * moved and the second the other way. I gets two columns each way. No
+ * floor kicks : a rotation never lifts a piece, so it can not climb.
+ */
+static void _board_kicks(int type)
+{
+    int dir, cw, s;
+    for (dir = BLOCK_DIR_0; dir <= BLOCK_DIR_270; dir ++)
+    {
+        for (cw = 0; cw < 2; cw ++)
+        {
+            int to = cw ? (dir + 1) & 3 : (dir + 3) & 3;
+            int shift = _board_center(type, dir) - _board_center(type, to);
+            signed char *k = block_kicks[type][dir][cw];
+            s = (shift > 0) ? 1 : ((shift < 0) ? -1 : (cw ? -1 : 1));
+            k[0] = 0;
+            k[1] = s;
+            k[2] = -s;
+            k[3] = 2 * s;
+            k[4] = -2 * s;
+        }
+    }
+
+    block_kick_count[type] = (BLOCK_O == type) ? 1 : ((BLOCK_I == type) ? 5 : 3);
+
+    return;
+}
+
+void board_init()
+{
+    int type, dir, ty, n;
+    for (type = BLOCK_L; type <= BLOCK_T; type ++)
+    {
+        for (dir = BLOCK_DIR_0; dir <= BLOCK_DIR_270; dir ++)
+        {
+            int tile = tile_block(type, dir);
+            for (ty = 0; ty < 4; ty ++)
+            {
+                // Tile keeps column 0 in the high bit of each nibble
+                n = (tile >> (ty * 4)) & 0xF;
+                block_rows[type][dir][ty] = ((n >> 3) & 1) | ((n >> 1) & 2) | ((n << 1) & 4) | ((n << 3) & 8);
+            }
+        }
+    }
+
+    for (type = BLOCK_L; type <= BLOCK_T; type ++)
+    {
+        _board_kicks(type);
+    }
+
+    // Resolve evaluation kernel before any worker thread can race on it
+    board_eval_kernel();
+
+    return;
+}
+
+static inline uint32_t _board_row(const struct tetris_board_t *b, int y)
+{
+    if (y < 0 || y >= PLAYGROUND_HEIGHT)
+    {
+        return 0xFFFFFFFF;
+    }
+
+    return ((uint32_t)b->rows[y] << BOARD_PAD) | BOARD_WALLS;
+}
+
+bool board_collide(const struct tetris_board_t *b, int type, int dir, int x, int y)
+{
+    if (x < -BOARD_PAD || x > PLAYGROUND_WIDTH)
+    {
+        return TRUE;
+    }
+
+    const uint16_t *m = block_rows[type][dir];
+    int i;
+    for (i = 0; i < 4; i ++)
+    {
+        if (m[i] && (_board_row(b, y + i) & ((uint32_t)m[i] << (x + BOARD_PAD))))
+        {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+// Piece rows against board rows loaded with _board_row, walls included
+static inline bool _board_fits(const uint32_t *r, const uint16_t *m, int x)
+{
+    if (x < -BOARD_PAD || x > PLAYGROUND_WIDTH)
+    {
+        return FALSE;
+    }
+
+    int shift = x + BOARD_PAD;
+
+    return 0 == ((r[0] & ((uint32_t)m[0] << shift)) | (r[1] & ((uint32_t)m[1] << shift)) |
+                 (r[2] & ((uint32_t)m[2] << shift)) | (r[3] & ((uint32_t)m[3] << shift)));
+}
+
+// Kicks in order from x against rows at the piece, new x or INT_MIN
+static inline int _board_kick(const uint32_t *r, int type, int dir, int clockwise, int x)
+{
+    const signed char *k = block_kicks[type][dir][clockwise];
+    const uint16_t *m = block_rows[type][clockwise ? (dir + 1) & 3 : (dir + 3) & 3];
+    int i;
+    for (i = 0; i < block_kick_count[type]; i ++)
+    {
+        if (_board_fits(r, m, x + k[i]))
+        {
+            return x + k[i];
+        }
+    }
+
+    return INT_MIN;
+}
+
+int board_rotate(const struct tetris_board_t *b, int type, int dir, bool clockwise, int *x, int y)
+{
+    uint32_t r[4] = {_board_row(b, y), _board_row(b, y + 1), _board_row(b, y + 2), _board_row(b, y + 3)};
+    int nx = _board_kick(r, type, dir, clockwise ? 1 : 0, *x);
+    if (INT_MIN == nx)
+    {
+        return -1;
+    }
+
+    *x = nx;
+
+    return clockwise ? (dir + 1) & 3 : (dir + 3) & 3;
+}
+
+// Landing height, walls and floor stop the block too
+int board_drop_distance(const struct tetris_board_t *b, int type, int dir, int x, int y)
+{
+    int d = 0;
+    while (!board_collide(b, type, dir, x, y - d - 1))
+    {
+        d ++;
+    }
+
+    return d;
+}
+
+bool board_cell(const struct tetris_board_t *b, int y, int x)
+{
+    return (b->rows[y] >> x) & 1;
+}
+
+void board_lock(struct tetris_board_t *b, int type, int dir, int x, int y)
+{
+    const uint16_t *m = block_rows[type][dir];
+    int i;
+    for (i = 0; i < 4; i ++)
+    {
+        if (m[i] && y + i >= 0 && y + i < PLAYGROUND_HEIGHT)
+        {
+            b->rows[y + i] |= (x >= 0) ? (m[i] << x) : (m[i] >> -x);
+        }
+    }
+
+    return;
+}
+
+int board_clear_lines(struct tetris_board_t *b)
+{
+    int i, copied = 0;
+    for (i = 0; i < PLAYGROUND_HEIGHT; i ++)
+    {
+        if (b->rows[i] != 0xFFFF)
+        {
+            b->rows[copied ++] = b->rows[i];
+        }
+    }
+
+    i = PLAYGROUND_HEIGHT - copied;
+    while (copied < PLAYGROUND_HEIGHT)
+    {
+        b->rows[copied ++] = 0;
+    }
+
+    return i;
+}
+
+bool board_garbage(struct tetris_board_t *b, int n, int hole)
+{
+    uint16_t over = 0;
+    int i;
+
+    if (n <= 0)
+    {
+        return FALSE;
+    }
+
+    if (n > PLAYGROUND_HEIGHT)
+    {
+        n = PLAYGROUND_HEIGHT;
+    }
+
+    for (i = PLAYGROUND_HEIGHT - n; i < PLAYGROUND_HEIGHT; i ++)
+    {
+        over |= b->rows[i];
+    }
+
+    memmove(b->rows + n, b->rows, sizeof(uint16_t) * (PLAYGROUND_HEIGHT - n));
+    for (i = 0; i < n; i ++)
+    {
+        b->rows[i] = 0xFFFF & ~(1 << hole);
+    }
+
+    return over != 0;
+}
+
+int board_load(struct tetris_board_t *b, const char *path)
+{
+    static char lines[PLAYGROUND_HEIGHT][64];
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL)
+    {
+        return -1;
+    }
+
+    int n = 0, i, j;
+    while (n < PLAYGROUND_HEIGHT && fgets(lines[n], sizeof(lines[n]), fp))
+    {
+        n ++;
+    }
+
+    fclose(fp);
+    memset(b, 0, sizeof(struct tetris_board_t));
+
+    // Bottom aligned, last line is row 0
+    for (i = 0; i < n; i ++)
+    {
+        for (j = 0; j < PLAYGROUND_WIDTH && lines[i][j] && lines[i][j] != '\n'; j ++)
+        {
+            if (lines[i][j] != '.' && lines[i][j] != ' ')
+            {
+                b->rows[n - 1 - i] |= 1 << j;
+            }
+        }
+
+        // A full row would have been cleared, no game reaches it
+        if (0xFFFF == b->rows[n - 1 - i])
+        {
+            errno = EINVAL;
+
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
@@ -0,0 +1,97 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file bot.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ */
+
+#include "tetris.h"
+
+// Reasonable starting point, tetris-tune searches from here
+const struct eval_weights_t bot_default_weights = {
+    -0.51f, -0.36f, -0.18f, 0.76f
+};
+
+int bot_choose(struct tetris_scene_t *s, const struct eval_weights_t *w, struct placement_t *out)
+{
+    struct placement_t list[MAX_PLACEMENTS];
+    struct board_batch_t batch;
+    struct board_eval_t eval;
+    struct tetris_board_t board;
+    float scores[EVAL_BATCH];
+    float best_score = 0;
+    int i, lane, n, best = -1;
+
+    BLOCK *curr = game_curr(s);
+    if (curr == NULL)
+    {
+        return -1;
+    }
+
+    n = movegen_placements(&s->board, curr->type, list);
+    for (i = 0; i < n; i += EVAL_BATCH)
+    {
+        int lanes = (n - i < EVAL_BATCH) ? n - i : EVAL_BATCH;
+        for (lane = 0; lane < lanes; lane ++)
+        {
+            memcpy(&board, &s->board, sizeof(struct tetris_board_t));
+            board_lock(&board, list[i + lane].type, list[i + lane].dir, list[i + lane].x, list[i + lane].y);
+            board_batch_put(&batch, lane, &board);
+        }
+
+        board_eval_batch(&batch, &eval);
+        board_score_batch(w, &eval, lanes, scores);
+        for (lane = 0; lane < lanes; lane ++)
+        {
+            // Locking at spawn row ends the game, only if nothing else fits
+            if (list[i + lane].y >= PLAYGROUND_HEIGHT - 4)
+            {
+                scores[lane] -= 1e6f;
+            }
+
+            if (best < 0 || scores[lane] > best_score)
+            {
+                best = i + lane;
+                best_score = scores[lane];
+            }
+        }
+    }
+
+    if (best >= 0)
+    {
+        *out = list[best];
+    }
+
+    return best;
+}
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
@@ -0,0 +1,253 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file botpipe.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ */
+
+#include "tetris.h"
+
+#define BOTPIPE_LINE                    4096
+
+static const char *botpipe_types = "-LSJIZOT";
+
+// Commands arrive on a raw descriptor, so we know when a read would block
+struct botpipe_reader_t
+{
+    int                 fd;
+    int                 len;
+    int                 pos;
+    char                buf[BOTPIPE_LINE];
+};
+
+// Next command line, NULL on EOF. Output is flushed only before we would wait for the bot
+static char * _botpipe_line(struct botpipe_reader_t *r, FILE *out)
+{
+    char *nl;
+    ssize_t n;
+
+    while (TRUE)
+    {
+        nl = memchr(r->buf + r->pos, '\n', r->len - r->pos);
+        if (nl != NULL)
+        {
+            char *line = r->buf + r->pos;
+            *nl = 0;
+            r->pos = nl - r->buf + 1;
+
+            return line;
+        }
+
+        // Compact, line longer than buffer is dropped
+        if (r->pos > 0)
+        {
+            memmove(r->buf, r->buf + r->pos, r->len - r->pos);
+            r->len -= r->pos;
+            r->pos = 0;
+        }
+
+        if (r->len >= BOTPIPE_LINE - 1)
+        {
+            r->len = 0;
+        }
+
+        fflush(out);
+        n = read(r->fd, r->buf + r->len, BOTPIPE_LINE - 1 - r->len);
+        if (n <= 0)
+        {
+            // Last line without newline
+            if (r->len > 0)
+            {
+                r->buf[r->len] = 0;
+                r->pos = r->len;
+
+                return r->buf;
+            }
+
+            return NULL;
+        }
+
+        r->len += n;
+    }
+}
+
+// State of the piece waiting for a command
+static void _botpipe_state(struct tetris_scene_t *s, FILE *out)
+{
+    int i, type;
+
+    fprintf(out, "piece %d %c ", s->blocks, botpipe_types[s->curr.type]);
+    for (i = 0; i < s->config.preview; i ++)
+    {
+        type = queue_peek(&s->queue, i, NULL);
+        fputc(botpipe_types[(type == BLOCK_UNKNOWN) ? 0 : type], out);
+    }
+
+    fprintf(out, " %d %d\nboard", s->score, s->lines);
+    for (i = 0; i < PLAYGROUND_HEIGHT; i ++)
+    {
+        fprintf(out, " %x", s->board.rows[i]);
+    }
+
+    fputc('\n', out);
+
+    return;
+}
+
+// Land current block straight down from where it is
+static int _botpipe_drop(struct tetris_scene_t *s)
+{
+    struct placement_t p;
+
+    p.x = s->curr.pos.x;
+    p.y = s->curr.pos.y - board_drop_distance(&s->board, s->curr.type, s->curr.direction, s->curr.pos.x, s->curr.pos.y);
+    p.dir = s->curr.direction;
+    p.type = s->curr.type;
+
+    return game_place(s, &p);
+}
+
+// Apply one command to the current block, error message if rejected
+static int _botpipe_apply(struct tetris_scene_t *s, char *line, const char **err)
+{
+    struct placement_t p;
+    char keys[BOTPIPE_LINE];
+    int x, y, dir, i;
+
+    *err = NULL;
+    p.type = s->curr.type;
+    if (3 == sscanf(line, "place %d %d %d", &x, &y, &dir))
+    {
+        // Range first, placement fields are narrower than int
+        if (x < -BOARD_PAD || x > PLAYGROUND_WIDTH || y < -BOARD_PAD || y >= PLAYGROUND_HEIGHT)
+        {
+            *err = "unreachable placement";
+
+            return _botpipe_drop(s);
+        }
+
+        p.x = x;
+        p.y = y;
+        p.dir = dir & 3;
+        if (dir < 0 || dir > 3 || !movegen_legal(&s->board, &p))
+        {
+            *err = "unreachable placement";
+
+            return _botpipe_drop(s);
+        }
+
+        return game_place(s, &p);
+    }
+
+    if (2 == sscanf(line, "drop %d %d", &x, &dir))
+    {
+        if (dir < 0 || dir > 3 || board_collide(&s->board, s->curr.type, dir, x, s->curr.pos.y))
+        {
+            *err = "blocked column";
+
+            return _botpipe_drop(s);
+        }
+
+        s->curr.pos.x = x;
+        s->curr.direction = dir;
+        s->curr.tile = tile_block(s->curr.type, dir);
+
+        return _botpipe_drop(s);
+    }
+
+    if (1 == sscanf(line, "keys %s", keys))
+    {
+        for (i = 0; keys[i] && keys[i] != 'x'; i ++)
+        {
+            switch (keys[i])
+            {
+                case 'l' : game_input(s, GAME_KEY_LEFT); break;
+                case 'r' : game_input(s, GAME_KEY_RIGHT); break;
+                case 'd' : game_input(s, GAME_KEY_DOWN); break;
+                case 'c' : game_input(s, GAME_KEY_ROTATE_CW); break;
+                case 'w' : game_input(s, GAME_KEY_ROTATE_CCW); break;
+                default :
+                    *err = "unknown key";
+
+                    break;
+            }
+        }
+
+        return _botpipe_drop(s);
+    }
+
+    *err = "unknown command";
+
+    return _botpipe_drop(s);
+}
+
+// Let an external process play, one command per block, no timer
+int botpipe_run(struct tetris_scene_t *s, int in, FILE *out)
+{
+    struct botpipe_reader_t reader;
+    const char *err;
+    char *line;
+    int ev = 0;
+
+    reader.fd = in;
+    reader.len = 0;
+    reader.pos = 0;
+    while (0 == (ev & EVENT_END))
+    {
+        game_spawn(s);
+        if (STATUS_PLAYING != s->status)
+        {
+            break;
+        }
+
+        // Bot sees the same preview as a player
+        queue_fill(&s->queue, s->config.randomizer, &s->rng, s->config.preview);
+        _botpipe_state(s, out);
+        if (NULL == (line = _botpipe_line(&reader, out)) || 0 == strncmp(line, "quit", 4))
+        {
+            break;
+        }
+
+        ev = _botpipe_apply(s, line, &err);
+        if (err != NULL)
+        {
+            fprintf(out, "error %d %s\n", s->blocks, err);
+        }
+    }
+
+    fprintf(out, "over %d %d %d\n", s->score, s->lines, s->blocks);
+    fflush(out);
+
+    return 0;
+}
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
@@ -0,0 +1,671 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file corpus.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ */
+
+#include <fcntl.h>
+#include <zlib.h>
+#include "tetris.h"
+
+/*
+ * Corpus file :
+ *     header
+ *     blocks of up to CORPUS_BLOCK_GAMES games :
+ *         block header, raw and stored size of every column
+ *         columns, each zlib compressed if the corpus asks for it and it pays
+ *     index of blocks (first game, games, offset)
+ *     footer, points at index
+ *
+ * Columns are varints. Seeds are deltas from the previous game of the block,
+ * event ticks deltas from the previous event of the game, signed values
+ * zigzag encoded. Readers hold one decoded block at a time, so memory is
+ * bounded by the block size whatever the corpus size.
+ */
+struct corpus_column_t
+{
+    unsigned char      *data;
+    size_t              len;
+    size_t              cap;
+};
+
+struct corpus_writer_t
+{
+    FILE               *fp;
+    int                 flags;
+    struct corpus_block_t
+                        block;
+    struct corpus_column_t
+                        columns[CORPUS_COLUMNS];
+    uint64_t            last_seed;
+    uint32_t            games;
+    uint32_t            count;
+    uint32_t            capacity;
+    struct corpus_index_t
+                       *index;
+    struct corpus_column_t
+                        packed;
+};
+
+struct corpus_t
+{
+    int                 fd;
+    uint32_t            games;
+    uint32_t            count;
+    struct corpus_index_t
+                       *index;
+
+    // Decoded block, -1 for none
+    int                 cached;
+    struct corpus_game_t
+                       *block_games;
+    struct replay_event_t
+                       *events;
+    struct corpus_column_t
+                        stored;
+    struct corpus_column_t
+                        columns[CORPUS_COLUMNS];
+};
+
+static int _column_reserve(struct corpus_column_t *c, size_t len)
+{
+    if (len > c->cap)
+    {
+        size_t cap = c->cap ? c->cap : 4096;
+        while (cap < len)
+        {
+            cap *= 2;
+        }
+
+        unsigned char *data = realloc(c->data, cap);
+        if (data == NULL)
+        {
+            return -1;
+        }
+
+        c->data = data;
+        c->cap = cap;
+    }
+
+    return 0;
+}
+
+static void _column_byte(struct corpus_column_t *c, unsigned char v)
+{
+    if (0 == _column_reserve(c, c->len + 1))
+    {
+        c->data[c->len ++] = v;
+    }
+
+    return;
+}
+
+static void _column_varint(struct corpus_column_t *c, uint64_t v)
+{
+    while (v >= 0x80)
+    {
+        _column_byte(c, (v & 0x7f) | 0x80);
+        v >>= 7;
+    }
+
+    _column_byte(c, v);
+
+    return;
+}
+
+static inline uint64_t _zigzag(int64_t v)
+{
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t _unzigzag(uint64_t v)
+{
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+// Column reader, a short or malformed column sets the cursor past the end
+struct corpus_cursor_t
+{
+    const unsigned char
+                       *p;
+    const unsigned char
+                       *end;
+};
+
+static uint64_t _cursor_varint(struct corpus_cursor_t *c)
+{
+    uint64_t v = 0;
+    int shift = 0;
+
+    while (c->p < c->end && shift < 64)
+    {
+        unsigned char b = *c->p ++;
+        v |= (uint64_t)(b & 0x7f) << shift;
+        if (0 == (b & 0x80))
+        {
+            return v;
+        }
+
+        shift += 7;
+    }
+
+    c->p = c->end + 1;
+
+    return 0;
+}
+
+static unsigned char _cursor_byte(struct corpus_cursor_t *c)
+{
+    if (c->p < c->end)
+    {
+        return *c->p ++;
+    }
+
+    c->p = c->end + 1;
+
+    return 0;
+}
+
+/* {{{ [Writer] */
+struct corpus_writer_t * corpus_create(const char *path, int flags)
+{
+    struct corpus_header_t header;
+    struct corpus_writer_t *w = calloc(1, sizeof(struct corpus_writer_t));
+
+    if (w == NULL)
+    {
+        return NULL;
+    }
+
+    if (NULL == (w->fp = fopen(path, "wb")))
+    {
+        free(w);
+
+        return NULL;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CORPUS_MAGIC, 8);
+    header.version = CORPUS_VERSION;
+    header.flags = flags;
+    header.block_games = CORPUS_BLOCK_GAMES;
+    fwrite(&header, sizeof(header), 1, w->fp);
+    w->flags = flags;
+
+    return w;
+}
+
+static int _corpus_flush(struct corpus_writer_t *w)
+{
+    struct corpus_block_t *b = &w->block;
+    int i;
+
+    if (0 == b->games)
+    {
+        return 0;
+    }
+
+    if (w->count == w->capacity)
+    {
+        uint32_t capacity = w->capacity ? w->capacity * 2 : 64;
+        struct corpus_index_t *index = realloc(w->index, sizeof(struct corpus_index_t) * capacity);
+        if (index == NULL)
+        {
+            return -1;
+        }
+
+        w->index = index;
+        w->capacity = capacity;
+    }
+
+    w->index[w->count].first = w->games - b->games;
+    w->index[w->count].games = b->games;
+    w->index[w->count].offset = ftell(w->fp);
+    w->count ++;
+
+    // Compress every column into one buffer first, header goes in front of it
+    w->packed.len = 0;
+    for (i = 0; i < CORPUS_COLUMNS; i ++)
+    {
+        struct corpus_column_t *c = &w->columns[i];
+        b->raw[i] = c->len;
+        b->stored[i] = c->len;
+        if (w->flags & CORPUS_ZLIB)
+        {
+            uLongf len = compressBound(c->len);
+            if (0 != _column_reserve(&w->packed, w->packed.len + len))
+            {
+                return -1;
+            }
+
+            if (Z_OK == compress2(w->packed.data + w->packed.len, &len, c->data, c->len, Z_BEST_SPEED) && len < c->len)
+            {
+                b->stored[i] = len;
+                w->packed.len += len;
+
+                continue;
+            }
+        }
+
+        if (0 != _column_reserve(&w->packed, w->packed.len + c->len))
+        {
+            return -1;
+        }
+
+        memcpy(w->packed.data + w->packed.len, c->data, c->len);
+        w->packed.len += c->len;
+    }
+
+    if (1 != fwrite(b, sizeof(struct corpus_block_t), 1, w->fp) ||
+        (w->packed.len > 0 && 1 != fwrite(w->packed.data, w->packed.len, 1, w->fp)))
+    {
+        return -1;
+    }
+
+    memset(b, 0, sizeof(struct corpus_block_t));
+    for (i = 0; i < CORPUS_COLUMNS; i ++)
+    {
+        w->columns[i].len = 0;
+    }
+
+    w->last_seed = 0;
+
+    return 0;
+}
+
+int corpus_add(struct corpus_writer_t *w, const struct corpus_game_t *g)
+{
+    struct corpus_column_t *c = w->columns;
+    uint32_t i, tick = 0;
+
+    _column_varint(&c[CORPUS_COL_SEED], _zigzag((int64_t)(g->config.seed - w->last_seed)));
+    w->last_seed = g->config.seed;
+    _column_varint(&c[CORPUS_COL_CONFIG], g->config.level);
+    _column_varint(&c[CORPUS_COL_CONFIG], g->config.preview);
+    _column_varint(&c[CORPUS_COL_CONFIG], g->config.randomizer);
+    _column_varint(&c[CORPUS_COL_CONFIG], g->gravity);
+    _column_varint(&c[CORPUS_COL_CONFIG], g->egg);
+    _column_varint(&c[CORPUS_COL_OUTCOME], g->status);
+    _column_varint(&c[CORPUS_COL_OUTCOME], g->score);
+    _column_varint(&c[CORPUS_COL_OUTCOME], g->blocks);
+    _column_varint(&c[CORPUS_COL_OUTCOME], g->lines);
+    _column_varint(&c[CORPUS_COL_OUTCOME], g->end_tick);
+    _column_varint(&c[CORPUS_COL_OUTCOME], g->replay_hash);
+    _column_varint(&c[CORPUS_COL_COUNT], g->events_count);
+    for (i = 0; i < g->events_count; i ++)
+    {
+        const struct replay_event_t *e = &g->events[i];
+        _column_varint(&c[CORPUS_COL_TICK], e->tick - tick);
+        tick = e->tick;
+        _column_byte(&c[CORPUS_COL_KIND], e->kind);
+        if (REPLAY_PLACE == e->kind)
+        {
+            _column_varint(&c[CORPUS_COL_PLACE], _zigzag(e->x));
+            _column_varint(&c[CORPUS_COL_PLACE], _zigzag(e->y));
+            _column_byte(&c[CORPUS_COL_PLACE], e->v);
+        }
+        else
+        {
+            _column_byte(&c[CORPUS_COL_KEY], e->v);
+        }
+    }
+
+    w->block.games ++;
+    w->block.events += g->events_count;
+    w->games ++;
+    if (w->block.games >= CORPUS_BLOCK_GAMES || w->block.events >= CORPUS_BLOCK_EVENTS)
+    {
+        return _corpus_flush(w);
+    }
+
+    return 0;
+}
+
+int corpus_finish(struct corpus_writer_t *w)
+{
+    struct corpus_footer_t footer;
+    int ret = _corpus_flush(w);
+    int i;
+
+    memset(&footer, 0, sizeof(footer));
+    footer.index_offset = ftell(w->fp);
+    footer.blocks = w->count;
+    footer.games = w->games;
+    memcpy(footer.magic, CORPUS_INDEX_MAGIC, 8);
+    if (w->count != fwrite(w->index, sizeof(struct corpus_index_t), w->count, w->fp) ||
+        1 != fwrite(&footer, sizeof(footer), 1, w->fp))
+    {
+        ret = -1;
+    }
+
+    if (0 != fclose(w->fp))
+    {
+        ret = -1;
+    }
+
+    for (i = 0; i < CORPUS_COLUMNS; i ++)
+    {
+        free(w->columns[i].data);
+    }
+
+    free(w->packed.data);
+    free(w->index);
+    free(w);
+
+    return ret;
+}
+/* }}} */
+
+/* {{{ [Reader] */
+struct corpus_t * corpus_open(const char *path)
+{
+    struct corpus_header_t header;
+    struct corpus_footer_t footer;
+    struct corpus_t *c;
+    off_t size;
+    int fd;
+
+    if (0 > (fd = open(path, O_RDONLY)))
+    {
+        return NULL;
+    }
+
+    size = lseek(fd, 0, SEEK_END);
+    if (size < (off_t)(sizeof(header) + sizeof(footer)) ||
+        sizeof(header) != pread(fd, &header, sizeof(header), 0) ||
+        sizeof(footer) != pread(fd, &footer, sizeof(footer), size - sizeof(footer)) ||
+        0 != memcmp(header.magic, CORPUS_MAGIC, 8) || CORPUS_VERSION != header.version ||
+        0 != memcmp(footer.magic, CORPUS_INDEX_MAGIC, 8) ||
+        footer.index_offset + sizeof(struct corpus_index_t) * footer.blocks + sizeof(footer) != (uint64_t)size ||
+        NULL == (c = calloc(1, sizeof(struct corpus_t))))
+    {
+        close(fd);
+
+        return NULL;
+    }
+
+    c->fd = fd;
+    c->games = footer.games;
+    c->count = footer.blocks;
+    c->cached = -1;
+    c->index = malloc(sizeof(struct corpus_index_t) * (c->count ? c->count : 1));
+    c->block_games = malloc(sizeof(struct corpus_game_t) * CORPUS_BLOCK_GAMES);
+    if (c->index == NULL || c->block_games == NULL ||
+        (ssize_t)(sizeof(struct corpus_index_t) * c->count) != pread(fd, c->index, sizeof(struct corpus_index_t) * c->count, footer.index_offset))
+    {
+        corpus_close(c);
+
+        return NULL;
+    }
+
+    return c;
+}
+
+void corpus_close(struct corpus_t *c)
+{
+    int i;
+
+    if (c == NULL)
+    {
+        return;
+    }
+
+    for (i = 0; i < CORPUS_COLUMNS; i ++)
+    {
+        free(c->columns[i].data);
+    }
+
+    free(c->stored.data);
+    free(c->events);
+    free(c->block_games);
+    free(c->index);
+    close(c->fd);
+    free(c);
+
+    return;
+}
+
+int corpus_games(const struct corpus_t *c)
+{
+    return c->games;
+}
+
+// Read, inflate and decode block k into the cache
+static int _corpus_load(struct corpus_t *c, uint32_t k)
+{
+    struct corpus_block_t b;
+    struct corpus_cursor_t col[CORPUS_COLUMNS];
+    size_t stored = 0, at = 0;
+    uint32_t i, j, n = 0;
+    uint64_t seed = 0;
+    int ret = 0;
+
+    c->cached = -1;
+    if (sizeof(b) != pread(c->fd, &b, sizeof(b), c->index[k].offset) ||
+        b.games != c->index[k].games || b.games > CORPUS_BLOCK_GAMES)
+    {
+        return -1;
+    }
+
+    for (i = 0; i < CORPUS_COLUMNS; i ++)
+    {
+        stored += b.stored[i];
+    }
+
+    if (0 != _column_reserve(&c->stored, stored) ||
+        (ssize_t)stored != pread(c->fd, c->stored.data, stored, c->index[k].offset + sizeof(b)))
+    {
+        return -1;
+    }
+
+    for (i = 0; i < CORPUS_COLUMNS; i ++)
+    {
+        struct corpus_column_t *dst = &c->columns[i];
+        if (0 != _column_reserve(dst, b.raw[i]))
+        {
+            return -1;
+        }
+
+        if (b.stored[i] < b.raw[i])
+        {
+            uLongf len = b.raw[i];
+            if (Z_OK != uncompress(dst->data, &len, c->stored.data + at, b.stored[i]) || len != b.raw[i])
+            {
+                return -1;
+            }
+        }
+        else if (b.raw[i] > 0)
+        {
+            memcpy(dst->data, c->stored.data + at, b.raw[i]);
+        }
+
+        dst->len = b.raw[i];
+        at += b.stored[i];
+        col[i].p = dst->data;
+        col[i].end = dst->data + dst->len;
+    }
+
+    struct replay_event_t *events = realloc(c->events, sizeof(struct replay_event_t) * (b.events ? b.events : 1));
+    if (events == NULL)
+    {
+        return -1;
+    }
+
+    c->events = events;
+    for (i = 0; i < b.games; i ++)
+    {
+        struct corpus_game_t *g = &c->block_games[i];
+        uint32_t tick = 0;
+
+        seed += _unzigzag(_cursor_varint(&col[CORPUS_COL_SEED]));
+        g->config.seed = seed;
+        g->config.level = _cursor_varint(&col[CORPUS_COL_CONFIG]);
+        g->config.preview = _cursor_varint(&col[CORPUS_COL_CONFIG]);
+        g->config.randomizer = _cursor_varint(&col[CORPUS_COL_CONFIG]);
+        g->gravity = _cursor_varint(&col[CORPUS_COL_CONFIG]);
+        g->egg = _cursor_varint(&col[CORPUS_COL_CONFIG]);
+        if (g->config.level < MIN_TETRIS_LEVEL || g->config.level > MAX_TETRIS_LEVEL ||
+            g->config.preview < MIN_PREVIEW || g->config.preview > MAX_PREVIEW ||
+            g->config.randomizer > RANDOMIZER_HISTORY || 0 == g->gravity)
+        {
+            return -1;
+        }
+
+        g->status = _cursor_varint(&col[CORPUS_COL_OUTCOME]);
+        g->score = _cursor_varint(&col[CORPUS_COL_OUTCOME]);
+        g->blocks = _cursor_varint(&col[CORPUS_COL_OUTCOME]);
+        g->lines = _cursor_varint(&col[CORPUS_COL_OUTCOME]);
+        g->end_tick = _cursor_varint(&col[CORPUS_COL_OUTCOME]);
+        g->replay_hash = _cursor_varint(&col[CORPUS_COL_OUTCOME]);
+        g->events_count = _cursor_varint(&col[CORPUS_COL_COUNT]);
+        if (g->events_count > b.events - n)
+        {
+            return -1;
+        }
+
+        g->events = c->events + n;
+        for (j = 0; j < g->events_count; j ++, n ++)
+        {
+            struct replay_event_t *e = &c->events[n];
+            tick += _cursor_varint(&col[CORPUS_COL_TICK]);
+            e->tick = tick;
+            e->kind = _cursor_byte(&col[CORPUS_COL_KIND]);
+            e->x = e->y = 0;
+            if (REPLAY_PLACE == e->kind)
+            {
+                e->x = _unzigzag(_cursor_varint(&col[CORPUS_COL_PLACE]));
+                e->y = _unzigzag(_cursor_varint(&col[CORPUS_COL_PLACE]));
+                e->v = _cursor_byte(&col[CORPUS_COL_PLACE]);
+            }
+            else
+            {
+                e->v = _cursor_byte(&col[CORPUS_COL_KEY]);
+            }
+        }
+    }
+
+    for (i = 0; i < CORPUS_COLUMNS; i ++)
+    {
+        if (col[i].p > col[i].end)
+        {
+            ret = -1;
+        }
+    }
+
+    if (0 == ret)
+    {
+        c->cached = k;
+    }
+
+    return ret;
+}
+
+int corpus_get(struct corpus_t *c, int i, struct corpus_game_t *g)
+{
+    uint32_t lo = 0, hi = c->count;
+
+    if (i < 0 || (uint32_t)i >= c->games)
+    {
+        return -1;
+    }
+
+    // Sequential readers stay in the cached block
+    if (c->cached < 0 || (uint32_t)i < c->index[c->cached].first ||
+        (uint32_t)i >= c->index[c->cached].first + c->index[c->cached].games)
+    {
+        while (hi - lo > 1)
+        {
+            uint32_t mid = (lo + hi) / 2;
+            if (c->index[mid].first <= (uint32_t)i)
+            {
+                lo = mid;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+
+        if (0 != _corpus_load(c, lo))
+        {
+            return -1;
+        }
+    }
+
+    memcpy(g, &c->block_games[i - c->index[c->cached].first], sizeof(struct corpus_game_t));
+
+    return 0;
+}
+/* }}} */
+
+void corpus_play(const struct corpus_game_t *g, struct tetris_scene_t *s)
+{
+    const struct replay_event_t *e = g->events, *end = g->events + g->events_count;
+    struct placement_t p;
+    int ev;
+
+    game_init(s, &g->config);
+    s->gravity = g->gravity;
+    s->egg = g->egg;
+
+    // Topping out does not advance the clock, a finished game also plays its last tick
+    uint64_t until = (STATUS_OVER == g->status || STATUS_EGG == g->status) ? g->end_tick + 1 : g->end_tick;
+    while (s->timer_counter < until)
+    {
+        uint32_t tick = s->timer_counter;
+        for (; e < end && e->tick == tick && REPLAY_KEY == e->kind; e ++)
+        {
+            game_input(s, e->v);
+        }
+
+        ev = game_tick(s);
+        for (; e < end && e->tick == tick && REPLAY_PLACE == e->kind; e ++)
+        {
+            p.x = e->x;
+            p.y = e->y;
+            p.dir = e->v;
+            p.type = s->curr.type;
+            ev |= game_place(s, &p);
+        }
+
+        if (ev & EVENT_END)
+        {
+            break;
+        }
+    }
+
+    return;
+}
+
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
@@ -0,0 +1,284 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file eval.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ */
+
+#include "tetris.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define EVAL_X86                        1
+#endif
+
+typedef void (*eval_kernel_f)(const struct board_batch_t *, struct board_eval_t *);
+
+static eval_kernel_f eval_kernel = NULL;
+static const char *eval_kernel_name = "scalar";
+
+void board_batch_put(struct board_batch_t *batch, int lane, const struct tetris_board_t *b)
+{
+    int y;
+    for (y = 0; y < PLAYGROUND_HEIGHT; y ++)
+    {
+        batch->rows[y][lane] = b->rows[y];
+    }
+
+    return;
+}
+
+/*
+ * All kernels scan rows bottom-up once. A full row bumps the cleared line
+ * counter instead of taking part, so every cell above sinks by one and the
+ * height of a column is the effective row of its last filled cell. Holes
+ * fall out as aggregate height minus filled cells.
+ */
+static void _eval_scalar(const struct board_batch_t *batch, struct board_eval_t *out)
+{
+    int lane, y, c;
+    for (lane = 0; lane < EVAL_BATCH; lane ++)
+    {
+        int h[PLAYGROUND_WIDTH] = {0};
+        int lines = 0, cells = 0, agg = 0, bump = 0;
+        for (y = 0; y < PLAYGROUND_HEIGHT; y ++)
+        {
+            unsigned int r = batch->rows[y][lane];
+            if (r == 0xFFFF)
+            {
+                lines ++;
+                continue;
+            }
+
+            cells += __builtin_popcount(r);
+            for (c = 0; c < PLAYGROUND_WIDTH; c ++)
+            {
+                if ((r >> c) & 1)
+                {
+                    h[c] = y + 1 - lines;
+                }
+            }
+        }
+
+        for (c = 0; c < PLAYGROUND_WIDTH; c ++)
+        {
+            agg += h[c];
+            if (c > 0)
+            {
+                bump += abs(h[c] - h[c - 1]);
+            }
+        }
+
+        out->height[lane] = agg;
+        out->holes[lane] = agg - cells;
+        out->bumpiness[lane] = bump;
+        out->lines[lane] = lines;
+    }
+
+    return;
+}
+
+#ifdef EVAL_X86
+// Eight lanes per register, two passes for one batch
+static void _eval_sse2(const struct board_batch_t *batch, struct board_eval_t *out)
+{
+    int half, y, c;
+    for (half = 0; half < EVAL_BATCH; half += 8)
+    {
+        __m128i h[PLAYGROUND_WIDTH];
+        __m128i lines = _mm_setzero_si128();
+        __m128i cells = _mm_setzero_si128();
+        __m128i ones = _mm_set1_epi16(-1);
+        for (c = 0; c < PLAYGROUND_WIDTH; c ++)
+        {
+            h[c] = _mm_setzero_si128();
+        }
+
+        for (y = 0; y < PLAYGROUND_HEIGHT; y ++)
+        {
+            __m128i r = _mm_load_si128((const __m128i *)&batch->rows[y][half]);
+            __m128i full = _mm_cmpeq_epi16(r, ones);
+            lines = _mm_sub_epi16(lines, full);
+            r = _mm_andnot_si128(full, r);
+
+            // Popcount in 16-bit lanes
+            __m128i p = _mm_sub_epi16(r, _mm_and_si128(_mm_srli_epi16(r, 1), _mm_set1_epi16(0x5555)));
+            p = _mm_add_epi16(_mm_and_si128(p, _mm_set1_epi16(0x3333)), _mm_and_si128(_mm_srli_epi16(p, 2), _mm_set1_epi16(0x3333)));
+            p = _mm_and_si128(_mm_add_epi16(p, _mm_srli_epi16(p, 4)), _mm_set1_epi16(0x0F0F));
+            p = _mm_and_si128(_mm_add_epi16(p, _mm_srli_epi16(p, 8)), _mm_set1_epi16(0x1F));
+            cells = _mm_add_epi16(cells, p);
+
+            __m128i eff = _mm_sub_epi16(_mm_set1_epi16(y + 1), lines);
+            for (c = 0; c < PLAYGROUND_WIDTH; c ++)
+            {
+                __m128i bit = _mm_set1_epi16(1 << c);
+                __m128i m = _mm_cmpeq_epi16(_mm_and_si128(r, bit), bit);
+                h[c] = _mm_or_si128(_mm_and_si128(m, eff), _mm_andnot_si128(m, h[c]));
+            }
+        }
+
+        __m128i agg = h[0];
+        __m128i bump = _mm_setzero_si128();
+        for (c = 1; c < PLAYGROUND_WIDTH; c ++)
+        {
+            agg = _mm_add_epi16(agg, h[c]);
+            bump = _mm_add_epi16(bump, _mm_or_si128(_mm_subs_epu16(h[c], h[c - 1]), _mm_subs_epu16(h[c - 1], h[c])));
+        }
+
+        _mm_store_si128((__m128i *)&out->height[half], agg);
+        _mm_store_si128((__m128i *)&out->holes[half], _mm_sub_epi16(agg, cells));
+        _mm_store_si128((__m128i *)&out->bumpiness[half], bump);
+        _mm_store_si128((__m128i *)&out->lines[half], lines);
+    }
+
+    return;
+}
+
+// Whole batch in one register
+__attribute__((target("avx2")))
+static void _eval_avx2(const struct board_batch_t *batch, struct board_eval_t *out)
+{
+    int y, c;
+    __m256i h[PLAYGROUND_WIDTH];
+    __m256i lines = _mm256_setzero_si256();
+    __m256i cells = _mm256_setzero_si256();
+    __m256i ones = _mm256_set1_epi16(-1);
+    for (c = 0; c < PLAYGROUND_WIDTH; c ++)
+    {
+        h[c] = _mm256_setzero_si256();
+    }
+
+    for (y = 0; y < PLAYGROUND_HEIGHT; y ++)
+    {
+        __m256i r = _mm256_load_si256((const __m256i *)batch->rows[y]);
+        __m256i full = _mm256_cmpeq_epi16(r, ones);
+        lines = _mm256_sub_epi16(lines, full);
+        r = _mm256_andnot_si256(full, r);
+
+        __m256i p = _mm256_sub_epi16(r, _mm256_and_si256(_mm256_srli_epi16(r, 1), _mm256_set1_epi16(0x5555)));
+        p = _mm256_add_epi16(_mm256_and_si256(p, _mm256_set1_epi16(0x3333)), _mm256_and_si256(_mm256_srli_epi16(p, 2), _mm256_set1_epi16(0x3333)));
+        p = _mm256_and_si256(_mm256_add_epi16(p, _mm256_srli_epi16(p, 4)), _mm256_set1_epi16(0x0F0F));
+        p = _mm256_and_si256(_mm256_add_epi16(p, _mm256_srli_epi16(p, 8)), _mm256_set1_epi16(0x1F));
+        cells = _mm256_add_epi16(cells, p);
+
+        __m256i eff = _mm256_sub_epi16(_mm256_set1_epi16(y + 1), lines);
+        for (c = 0; c < PLAYGROUND_WIDTH; c ++)
+        {
+            __m256i bit = _mm256_set1_epi16(1 << c);
+            __m256i m = _mm256_cmpeq_epi16(_mm256_and_si256(r, bit), bit);
+            h[c] = _mm256_blendv_epi8(h[c], eff, m);
+        }
+    }
+
+    __m256i agg = h[0];
+    __m256i bump = _mm256_setzero_si256();
+    for (c = 1; c < PLAYGROUND_WIDTH; c ++)
+    {
+        agg = _mm256_add_epi16(agg, h[c]);
+        bump = _mm256_add_epi16(bump, _mm256_abs_epi16(_mm256_sub_epi16(h[c], h[c - 1])));
+    }
+
+    _mm256_store_si256((__m256i *)out->height, agg);
+    _mm256_store_si256((__m256i *)out->holes, _mm256_sub_epi16(agg, cells));
+    _mm256_store_si256((__m256i *)out->bumpiness, bump);
+    _mm256_store_si256((__m256i *)out->lines, lines);
+
+    return;
+}
+#endif
+
+// Pick kernel once, TETRIS_EVAL=scalar|sse2|avx2 overrides detection
+static void _eval_select()
+{
+    const char *force = getenv("TETRIS_EVAL");
+
+    eval_kernel = _eval_scalar;
+    eval_kernel_name = "scalar";
+#ifdef EVAL_X86
+    __builtin_cpu_init();
+    if (force != NULL && 0 == strcmp(force, "scalar"))
+    {
+        return;
+    }
+
+    if (__builtin_cpu_supports("avx2") && (force == NULL || 0 == strcmp(force, "avx2")))
+    {
+        eval_kernel = _eval_avx2;
+        eval_kernel_name = "avx2";
+    }
+    else if (__builtin_cpu_supports("sse2"))
+    {
+        eval_kernel = _eval_sse2;
+        eval_kernel_name = "sse2";
+    }
+#endif
+
+    return;
+}
+
+void board_eval_batch(const struct board_batch_t *batch, struct board_eval_t *out)
+{
+    if (eval_kernel == NULL)
+    {
+        _eval_select();
+    }
+
+    eval_kernel(batch, out);
+
+    return;
+}
+
+void board_score_batch(const struct eval_weights_t *w, const struct board_eval_t *e, int n, float *scores)
+{
+    int lane;
+    for (lane = 0; lane < n; lane ++)
+    {
+        scores[lane] = w->height * e->height[lane] +
+            w->holes * e->holes[lane] +
+            w->bumpiness * e->bumpiness[lane] +
+            w->lines * e->lines[lane];
+    }
+
+    return;
+}
+
+const char * board_eval_kernel()
+{
+    if (eval_kernel == NULL)
+    {
+        _eval_select();
+    }
+
+    return eval_kernel_name;
+}
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
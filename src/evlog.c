@@ -0,0 +1,262 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file evlog.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ *
+ * Structured binary event log. Every thread appends fixed size records to
+ * its own single producer ring : a clock read, a store and a release, no
+ * lock and no syscall. A flusher thread drains the rings to the file in
+ * batches. A ring the flusher can not keep up with drops records and
+ * counts them, the game never waits for the disk.
+ */
+
+#include <fcntl.h>
+#include <pthread.h>
+#include "tetris.h"
+
+struct evlog_ring_t
+{
+    unsigned long long int
+                        head __attribute__((aligned(64)));
+    unsigned long long int
+                        tail __attribute__((aligned(64)));
+    unsigned long long int
+                        dropped;
+    unsigned long long int
+                        reported;
+    struct evlog_record_t
+                        records[EVLOG_RING];
+};
+
+static struct
+{
+    struct evlog_ring_t
+                       *rings;
+    unsigned int        threads;
+    int                 fd;
+    bool                quit;
+    bool                failed;
+    pthread_t           flusher;
+} evlog;
+
+static __thread struct evlog_ring_t *evlog_ring = NULL;
+static __thread unsigned int evlog_thread = 0;
+
+bool evlog_on = FALSE;
+
+static const char *evlog_names[EVLOG_TYPES] = {
+    "none",
+    "tick",
+    "spawn",
+    "key",
+    "lock",
+    "clear",
+    "end",
+    "frame",
+    "dropped",
+};
+
+const char * evlog_name(int type)
+{
+    return (type >= 0 && type < EVLOG_TYPES) ? evlog_names[type] : "?";
+}
+
+static int _evlog_put(const void *buf, size_t len)
+{
+    const char *p = buf;
+    while (len > 0)
+    {
+        ssize_t w = write(evlog.fd, p, len);
+        if (w <= 0)
+        {
+            return -1;
+        }
+
+        p += w;
+        len -= w;
+    }
+
+    return 0;
+}
+
+// Everything published so far, in at most two writes per ring
+static void _evlog_drain()
+{
+    unsigned int i, n = __atomic_load_n(&evlog.threads, __ATOMIC_ACQUIRE);
+    if (n > EVLOG_THREADS)
+    {
+        n = EVLOG_THREADS;
+    }
+
+    for (i = 0; i < n; i ++)
+    {
+        struct evlog_ring_t *r = &evlog.rings[i];
+        unsigned long long int head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+        unsigned long long int tail = r->tail;
+        while (tail < head && !evlog.failed)
+        {
+            unsigned long long int at = tail & (EVLOG_RING - 1);
+            unsigned long long int k = head - tail;
+            if (k > EVLOG_RING - at)
+            {
+                k = EVLOG_RING - at;
+            }
+
+            evlog.failed = (0 != _evlog_put(&r->records[at], k * sizeof(struct evlog_record_t)));
+            tail += k;
+        }
+
+        __atomic_store_n(&r->tail, head, __ATOMIC_RELEASE);
+
+        // Losses are logged by the flusher, under the thread that had them
+        unsigned long long int dropped = __atomic_load_n(&r->dropped, __ATOMIC_RELAXED);
+        if (dropped != r->reported && !evlog.failed)
+        {
+            struct evlog_record_t e = {perf_now(), EVLOG_DROPPED, i + 1, i + 1, dropped - r->reported};
+            evlog.failed = (0 != _evlog_put(&e, sizeof(e)));
+            r->reported = dropped;
+        }
+    }
+
+    return;
+}
+
+static void * _evlog_flusher(void *arg)
+{
+    struct timespec ts = {0, EVLOG_FLUSH_MS * 1000000};
+    while (!__atomic_load_n(&evlog.quit, __ATOMIC_ACQUIRE))
+    {
+        nanosleep(&ts, NULL);
+        _evlog_drain();
+    }
+
+    return NULL;
+}
+
+int evlog_open(const char *path)
+{
+    struct evlog_header_t h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, EVLOG_MAGIC, 8);
+    h.version = EVLOG_VERSION;
+    h.record_size = sizeof(struct evlog_record_t);
+    h.origin_ns = perf_now();
+    h.wall_s = time(NULL);
+
+    evlog.fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (evlog.fd < 0)
+    {
+        return -1;
+    }
+
+    evlog.rings = calloc(EVLOG_THREADS, sizeof(struct evlog_ring_t));
+    if (evlog.rings == NULL || 0 != _evlog_put(&h, sizeof(h)))
+    {
+        free(evlog.rings);
+        close(evlog.fd);
+
+        return -1;
+    }
+
+    evlog.quit = FALSE;
+    if (0 != pthread_create(&evlog.flusher, NULL, _evlog_flusher, NULL))
+    {
+        free(evlog.rings);
+        close(evlog.fd);
+
+        return -1;
+    }
+
+    __atomic_store_n(&evlog_on, TRUE, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+// Hot path, first record of a thread claims its ring
+void evlog_write(enum evlog_type_e type, uint16_t a, uint32_t b)
+{
+    struct evlog_ring_t *r = evlog_ring;
+    if (r == NULL)
+    {
+        if (evlog_thread > 0)
+        {
+            return;
+        }
+
+        evlog_thread = __atomic_add_fetch(&evlog.threads, 1, __ATOMIC_ACQ_REL);
+        if (evlog_thread > EVLOG_THREADS)
+        {
+            return;
+        }
+
+        r = evlog_ring = &evlog.rings[evlog_thread - 1];
+    }
+
+    unsigned long long int head = r->head;
+    if (head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) >= EVLOG_RING)
+    {
+        __atomic_fetch_add(&r->dropped, 1, __ATOMIC_RELAXED);
+
+        return;
+    }
+
+    struct evlog_record_t *e = &r->records[head & (EVLOG_RING - 1)];
+    e->ns = perf_now();
+    e->type = type;
+    e->thread = evlog_thread;
+    e->a = a;
+    e->b = b;
+    __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+
+    return;
+}
+
+// Logging threads must have stopped, the rest of the rings is flushed
+int evlog_close()
+{
+    if (!evlog_on)
+    {
+        return 0;
+    }
+
+    __atomic_store_n(&evlog_on, FALSE, __ATOMIC_RELEASE);
+    __atomic_store_n(&evlog.quit, TRUE, __ATOMIC_RELEASE);
+    pthread_join(evlog.flusher, NULL);
+    _evlog_drain();
+    free(evlog.rings);
+    evlog.rings = NULL;
+
+    return (0 == close(evlog.fd) && !evlog.failed) ? 0 : -1;
+}
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
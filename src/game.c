@@ -0,0 +1,418 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file game.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ */
+
+#include "tetris.h"
+
+void game_config_default(struct game_config_t *c)
+{
+    memset(c, 0, sizeof(struct game_config_t));
+    c->level = DEFAULT_TETRIS_LEVEL;
+    c->seed = 0;
+    c->preview = DEFAULT_PREVIEW;
+    c->randomizer = RANDOMIZER_UNIFORM;
+
+    return;
+}
+
+// Reset game state, keeps terminal size of scene
+void game_init(struct tetris_scene_t *s, const struct game_config_t *c)
+{
+    int win_width = s->win_width;
+    int win_height = s->win_height;
+
+    memset(s, 0, sizeof(struct tetris_scene_t));
+    s->win_width = win_width;
+    s->win_height = win_height;
+    s->config = *c;
+    if (0 == s->config.seed)
+    {
+        s->config.seed = get_random();
+    }
+
+    s->status = STATUS_PREPARE;
+    s->replay_hash = REPLAY_HASH_SEED;
+    s->level = c->level;
+    s->gravity = calculate_gravity(c->level);
+    s->egg = EGG_SCORE;
+    rng_seed(&s->rng, s->config.seed);
+    queue_init(&s->queue);
+    queue_fill(&s->queue, s->config.randomizer, &s->rng, s->config.preview + 1);
+
+    return;
+}
+
+// FNV-1a over everything that steers the game, same inputs at same ticks give same hash
+static inline void _replay_mix(struct tetris_scene_t *s, uint32_t v)
+{
+    int i;
+    for (i = 0; i < 4; i ++)
+    {
+        s->replay_hash = (s->replay_hash ^ ((v >> (i * 8)) & 0xFF)) * 16777619u;
+    }
+
+    return;
+}
+
+BLOCK * game_curr(struct tetris_scene_t *s)
+{
+    return (s->curr.type != BLOCK_UNKNOWN) ? &s->curr : NULL;
+}
+
+/* {{{ [Block activities] */
+static bool _curr_block_rotate(struct tetris_scene_t *s, bool clockwise, enum block_direction_e *dir, int *x)
+{
+    if (s->curr.type == BLOCK_UNKNOWN)
+    {
+        return FALSE;
+    }
+
+    int m_x = s->curr.pos.x;
+    int m_dir = board_rotate(&s->board, s->curr.type, s->curr.direction, clockwise, &m_x, s->curr.pos.y);
+    if (m_dir < 0)
+    {
+        return FALSE;
+    }
+
+    *dir = m_dir;
+    *x = m_x;
+
+    return TRUE;
+}
+
+static bool _curr_block_left(struct tetris_scene_t *s)
+{
+    if (s->curr.type == BLOCK_UNKNOWN)
+    {
+        return FALSE;
+    }
+
+    // Check edge
+    return !board_collide(&s->board, s->curr.type, s->curr.direction, s->curr.pos.x - 1, s->curr.pos.y);
+}
+
+static bool _curr_block_right(struct tetris_scene_t *s)
+{
+    if (s->curr.type == BLOCK_UNKNOWN)
+    {
+        return FALSE;
+    }
+
+    // Check edge
+    return !board_collide(&s->board, s->curr.type, s->curr.direction, s->curr.pos.x + 1, s->curr.pos.y);
+}
+
+static bool _curr_block_down(struct tetris_scene_t *s)
+{
+    if (s->curr.type == BLOCK_UNKNOWN)
+    {
+        return FALSE;
+    }
+
+    // Check edge
+    return !board_collide(&s->board, s->curr.type, s->curr.direction, s->curr.pos.x, s->curr.pos.y - 1);
+}
+
+static void _curr_block_solidify(struct tetris_scene_t *s)
+{
+    board_lock(&s->board, s->curr.type, s->curr.direction, s->curr.pos.x, s->curr.pos.y);
+    PROBE3(solidify, s->curr.type, s->curr.pos.x, s->curr.pos.y);
+    EVLOG(EVLOG_LOCK, s->curr.type, (uint8_t)s->curr.pos.x | (uint8_t)s->curr.pos.y << 8 | s->curr.direction << 16);
+
+    return;
+}
+
+/* }}} */
+
+// Calculate score, clear full row
+static int _check_score(struct tetris_scene_t *s)
+{
+    // 1 -> 3 / 2 -> 8 / 3 -> 20 / 4 -> 50
+    int e = board_clear_lines(&s->board);
+    PROBE1(clear, e);
+
+    // A lock clears 4 rows at most, count anything more as a tetris
+    if (e > 4)
+    {
+        e = 4;
+    }
+
+    s->stats.clears[e] ++;
+    switch (e)
+    {
+        case 4:
+            s->score += 50;
+            break;
+        case 3:
+            s->score += 20;
+            break;
+        case 2:
+            s->score += 8;
+            break;
+        case 0:
+            break;
+        default:
+            s->score += 3;
+            break;
+    }
+
+    s->lines += e;
+    EVLOG(EVLOG_CLEAR, e, s->score);
+
+    return e;
+}
+
+// Solidify falling block, then check failure / score / egg
+static int _game_lock(struct tetris_scene_t *s)
+{
+    _curr_block_solidify(s);
+
+    int top = s->curr.pos.y + 4;
+    while (top > s->curr.pos.y && 0 == s->curr.tile >> ((top - s->curr.pos.y - 1) * 4))
+    {
+        top --;
+    }
+
+    if (top > s->stats.peak_height)
+    {
+        s->stats.peak_height = top;
+    }
+
+    // Score, lines and status may move from here on
+    s->version ++;
+
+    // Failure?
+    if (PLAYGROUND_HEIGHT - 4 <= s->curr.pos.y)
+    {
+        s->status = STATUS_OVER;
+        EVLOG(EVLOG_END, s->status, s->score);
+
+        return EVENT_LOCK | EVENT_END;
+    }
+
+    s->curr.type = BLOCK_UNKNOWN;
+
+    // Check score
+    int ev = EVENT_LOCK;
+    uint64_t t = trace_clock();
+    if (_check_score(s) > 0)
+    {
+        ev |= EVENT_CLEAR;
+    }
+
+    trace_span("clear", t);
+
+    if (s->egg > 0 && s->score >= s->egg)
+    {
+        s->status = STATUS_EGG;
+        ev |= EVENT_END;
+        EVLOG(EVLOG_END, s->status, s->score);
+    }
+
+    return ev;
+}
+
+int game_spawn(struct tetris_scene_t *s)
+{
+    int ev = 0;
+
+    if (s->curr.type == BLOCK_UNKNOWN)
+    {
+        // Pointer bump, queue was topped up ahead of time unless nobody ticks (bots)
+        int color = 0;
+        queue_fill(&s->queue, s->config.randomizer, &s->rng, s->config.preview);
+        int type = queue_pop(&s->queue, &color);
+        new_block(&s->curr, type, color);
+        s->curr.pos.x = (PLAYGROUND_WIDTH - 4) / 2;
+        s->curr.pos.y = PLAYGROUND_HEIGHT - 4;
+        s->blocks ++;
+        s->score ++;
+        s->stats.pieces[s->curr.type] ++;
+        s->version ++;
+        PROBE2(spawn, s->curr.type, s->blocks);
+        EVLOG(EVLOG_SPAWN, s->curr.type, s->blocks);
+        if (STATUS_PREPARE == s->status)
+        {
+            s->status = STATUS_PLAYING;
+        }
+
+        ev |= EVENT_SPAWN;
+    }
+
+    return ev;
+}
+
+int game_tick(struct tetris_scene_t *s)
+{
+    if (STATUS_OVER == s->status || STATUS_EGG == s->status)
+    {
+        return EVENT_END;
+    }
+
+    PROBE1(tick, s->timer_counter);
+    int ev = game_spawn(s);
+    s->stats.level_ticks[s->level] ++;
+
+    // Whole rows due this tick, fraction carries over to the next
+    s->gravity_acc += s->gravity;
+    int rows = s->gravity_acc / GRAVITY_ONE;
+    s->gravity_acc %= GRAVITY_ONE;
+    if (s->curr.dropped)
+    {
+        rows = GRAVITY_INSTANT_ROWS;
+        s->gravity_acc = 0;
+    }
+
+    if (rows > 0)
+    {
+        // Move down automatically, several rows at once bounded by landing height
+        int d = board_drop_distance(&s->board, s->curr.type, s->curr.direction, s->curr.pos.x, s->curr.pos.y);
+        if (d > 0)
+        {
+            s->curr.pos.y -= (rows >= GRAVITY_INSTANT_ROWS || rows > d) ? d : rows;
+            ev |= EVENT_MOVE;
+        }
+        else
+        {
+            ev |= _game_lock(s);
+            if (ev & EVENT_END)
+            {
+                return ev;
+            }
+        }
+    }
+
+    // Generator runs on idle ticks, away from spawn and lock
+    if (0 == (ev & (EVENT_SPAWN | EVENT_LOCK)))
+    {
+        unsigned int tail = s->queue.tail;
+        queue_fill(&s->queue, s->config.randomizer, &s->rng, s->config.preview + 1);
+        if (tail != s->queue.tail)
+        {
+            s->version ++;
+        }
+    }
+
+    s->timer_counter ++;
+
+    return ev;
+}
+
+bool game_input(struct tetris_scene_t *s, enum game_key_e key)
+{
+    enum block_direction_e dir = BLOCK_DIR_0;
+    int x = 0;
+    bool moved = FALSE;
+
+    if (s->curr.type == BLOCK_UNKNOWN || STATUS_PLAYING != s->status)
+    {
+        return FALSE;
+    }
+
+    uint64_t t = trace_clock();
+    s->stats.keys ++;
+    _replay_mix(s, (uint32_t)s->timer_counter);
+    _replay_mix(s, key);
+    switch (key)
+    {
+        case GAME_KEY_LEFT:
+            if ((moved = _curr_block_left(s)))
+            {
+                s->curr.pos.x --;
+            }
+
+            break;
+        case GAME_KEY_RIGHT:
+            if ((moved = _curr_block_right(s)))
+            {
+                s->curr.pos.x ++;
+            }
+
+            break;
+        case GAME_KEY_DOWN:
+            if ((moved = _curr_block_down(s)))
+            {
+                s->curr.pos.y --;
+            }
+
+            break;
+        case GAME_KEY_DROP:
+            s->curr.pos.y -= board_drop_distance(&s->board, s->curr.type, s->curr.direction, s->curr.pos.x, s->curr.pos.y);
+
+            s->curr.dropped = TRUE;
+            moved = TRUE;
+
+            break;
+        case GAME_KEY_ROTATE_CCW:
+        case GAME_KEY_ROTATE_CW:
+            if ((moved = _curr_block_rotate(s, GAME_KEY_ROTATE_CW == key, &dir, &x)))
+            {
+                s->curr.direction = dir;
+                s->curr.tile = tile_block(s->curr.type, dir);
+                s->curr.pos.x = x;
+            }
+
+            break;
+        default:
+            break;
+    }
+
+    // Accepted or rejected, key is a game_key_e
+    PROBE2(input, key, moved);
+    EVLOG(EVLOG_KEY, key | moved << 8, s->timer_counter);
+    trace_span((GAME_KEY_ROTATE_CW == key || GAME_KEY_ROTATE_CCW == key) ? "rotate" : "move", t);
+
+    return moved;
+}
+
+// Bots skip the key by key path, placement comes from movegen
+int game_place(struct tetris_scene_t *s, const struct placement_t *p)
+{
+    if (s->curr.type == BLOCK_UNKNOWN || STATUS_PLAYING != s->status)
+    {
+        return 0;
+    }
+
+    _replay_mix(s, (uint32_t)s->timer_counter);
+    _replay_mix(s, (uint32_t)(unsigned char)p->x | (uint32_t)(unsigned char)p->y << 8 | (uint32_t)p->dir << 16);
+    s->curr.pos.x = p->x;
+    s->curr.pos.y = p->y;
+    s->curr.direction = p->dir;
+    s->curr.tile = tile_block(s->curr.type, p->dir);
+
+    return _game_lock(s);
+}
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
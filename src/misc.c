@@ -29,11 +29,12 @@
 
 #include <sys/types.h>
 #include <fcntl.h>
-#include <unistd.h>
+#include <math.h>
+#include "tetris.h"
 
 // Get ramdomize number from urandom device
 // Modify this for more flexibility randomize generator?
-int get_random()
+unsigned int get_random()
 {
     static char buf[4];
     int fd = open("/dev/urandom", O_RDONLY);
@@ -58,31 +59,83 @@ int get_random()
     return ret;
 }
 
-// Level => Speed
-unsigned long long int calculate_speed(int level)
+// Seed xorshift generator, splitmix the seed so nearby seeds diverge
+void rng_seed(uint64_t *state, uint64_t seed)
 {
-    switch (level)
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+    *state = z ? z : 0x9E3779B97F4A7C15ULL;
+
+    return;
+}
+
+// Deterministic randomize number (xorshift64*)
+unsigned int rng_next(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+
+    return (unsigned int)((x * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+// Level => Gravity, rows per tick (10ms). 1 - 9 follow the classic 200 ... 10 ticks per row,
+// rounded to 1 / GRAVITY_ONE a row may come a tick early or late
+static double gravity_curve[MAX_TETRIS_LEVEL + 1] = {
+    0,
+    1.0 / 200, 1.0 / 150, 1.0 / 100, 1.0 / 70, 1.0 / 55,
+    1.0 / 40, 1.0 / 25, 1.0 / 15, 1.0 / 10, 1.0 / 8,
+    1.0 / 6, 1.0 / 4, 1.0 / 3, 1.0 / 2, 1,
+    2, 3, 5, 10, GRAVITY_INSTANT_ROWS
+};
+
+unsigned int calculate_gravity(int level)
+{
+    if (level < MIN_TETRIS_LEVEL)
+    {
+        level = MIN_TETRIS_LEVEL;
+    }
+
+    if (level > MAX_TETRIS_LEVEL)
+    {
+        level = MAX_TETRIS_LEVEL;
+    }
+
+    return gravity_curve[level] * GRAVITY_ONE + 0.5;
+}
+
+int set_gravity_curve(const char *curve)
+{
+    const char *p = curve;
+    char *end;
+    int level = MIN_TETRIS_LEVEL;
+
+    while (*p && level <= MAX_TETRIS_LEVEL)
     {
-        case 1:
-            return 200;
-        case 2:
-            return 150;
-        case 3:
-            return 100;
-        case 4:
-            return 70;
-        case 5:
-            return 55;
-        case 6:
-            return 40;
-        case 7:
-            return 25;
-        case 8:
-            return 15;
-        case 9:
-        default:
-            return 10;
-    };
+        double g = strtod(p, &end);
+
+        // Below 1 / GRAVITY_ONE the fixed point gravity rounds to 0, the block would never fall. NaN compares false
+        if (end == p || !isfinite(g) || g * GRAVITY_ONE < 1 || g > GRAVITY_INSTANT_ROWS)
+        {
+            return -1;
+        }
+
+        gravity_curve[level ++] = g;
+        p = (*end == ',') ? end + 1 : end;
+    }
+
+    // Levels not given keep the last one
+    while (level <= MAX_TETRIS_LEVEL && level > MIN_TETRIS_LEVEL)
+    {
+        gravity_curve[level] = gravity_curve[level - 1];
+        level ++;
+    }
+
+    return 0;
 }
 
 /*
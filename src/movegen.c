@@ -0,0 +1,221 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file movegen.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ */
+
+#include "tetris.h"
+
+// Search space, position offsets keep negative tile origins inside the maps
+#define MOVEGEN_X_OFF                   4
+#define MOVEGEN_Y_OFF                   4
+#define MOVEGEN_ROWS                    (PLAYGROUND_HEIGHT + MOVEGEN_Y_OFF)
+#define MOVEGEN_STATES                  (4 * MOVEGEN_ROWS * (PLAYGROUND_WIDTH + MOVEGEN_X_OFF))
+
+// Cells of final position, used to fold rotations covering the same cells
+static inline uint64_t _placement_cells(int type, int dir, int x, int *base)
+{
+    const uint16_t *m = block_rows[type][dir];
+    uint64_t cells = 0;
+    int i, f = -1;
+    for (i = 0; i < 4; i ++)
+    {
+        if (m[i] == 0)
+        {
+            continue;
+        }
+
+        if (f < 0)
+        {
+            f = i;
+        }
+
+        cells |= (uint64_t)(uint16_t)((x >= 0) ? (m[i] << x) : (m[i] >> -x)) << ((i - f) * 16);
+    }
+
+    *base += f;
+
+    return cells;
+}
+
+// BFS over (x, y, direction) with the same moves as a player : left / right / down / rotation
+int movegen_placements(const struct tetris_board_t *b, int type, struct placement_t *out)
+{
+    uint32_t visited[4][MOVEGEN_ROWS];
+    struct placement_t queue[MOVEGEN_STATES];
+    uint64_t cells[MAX_PLACEMENTS];
+    int bases[MAX_PLACEMENTS];
+    int head = 0, tail = 0, n = 0;
+    int x = (PLAYGROUND_WIDTH - 4) / 2;
+    int y = PLAYGROUND_HEIGHT - 4;
+
+    if (board_collide(b, type, BLOCK_DIR_0, x, y))
+    {
+        return 0;
+    }
+
+    memset(visited, 0, sizeof(visited));
+    visited[BLOCK_DIR_0][y + MOVEGEN_Y_OFF] |= 1 << (x + MOVEGEN_X_OFF);
+    queue[tail].x = x;
+    queue[tail].y = y;
+    queue[tail].dir = BLOCK_DIR_0;
+    queue[tail].type = type;
+    tail ++;
+
+    while (head < tail)
+    {
+        struct placement_t s = queue[head ++];
+        int i, k, base;
+        int nx[4] = {s.x - 1, s.x + 1, s.x, s.x};
+        int ny[4] = {s.y, s.y, s.y, s.y};
+        int nd[4] = {s.dir, s.dir, (s.dir + 1) & 3, (s.dir + 3) & 3};
+
+        // Resting here?
+        if (board_collide(b, type, s.dir, s.x, s.y - 1))
+        {
+            base = s.y;
+            uint64_t c = _placement_cells(type, s.dir, s.x, &base);
+            for (k = 0; k < n; k ++)
+            {
+                if (cells[k] == c && bases[k] == base)
+                {
+                    break;
+                }
+            }
+
+            if (k == n && n < MAX_PLACEMENTS)
+            {
+                cells[n] = c;
+                bases[n] = base;
+                out[n ++] = s;
+            }
+        }
+        else if (!(visited[s.dir][s.y - 1 + MOVEGEN_Y_OFF] & (1 << (s.x + MOVEGEN_X_OFF))))
+        {
+            visited[s.dir][s.y - 1 + MOVEGEN_Y_OFF] |= 1 << (s.x + MOVEGEN_X_OFF);
+            queue[tail] = s;
+            queue[tail ++].y = s.y - 1;
+        }
+
+        for (i = 0; i < 4; i ++)
+        {
+            if (visited[nd[i]][ny[i] + MOVEGEN_Y_OFF] & (1 << (nx[i] + MOVEGEN_X_OFF)))
+            {
+                continue;
+            }
+
+            // Plain rotation blocked, the kicks decide where it lands
+            if (board_collide(b, type, nd[i], nx[i], ny[i]))
+            {
+                if (i < 2 || board_rotate(b, type, s.dir, 2 == i, &nx[i], ny[i]) < 0 ||
+                    (visited[nd[i]][ny[i] + MOVEGEN_Y_OFF] & (1 << (nx[i] + MOVEGEN_X_OFF))))
+                {
+                    continue;
+                }
+            }
+
+            visited[nd[i]][ny[i] + MOVEGEN_Y_OFF] |= 1 << (nx[i] + MOVEGEN_X_OFF);
+            queue[tail].x = nx[i];
+            queue[tail].y = ny[i];
+            queue[tail].dir = nd[i];
+            queue[tail].type = type;
+            tail ++;
+        }
+    }
+
+    return n;
+}
+
+// Placement covers the same cells as one of the generated ones
+bool movegen_legal(const struct tetris_board_t *b, const struct placement_t *p)
+{
+    struct placement_t list[MAX_PLACEMENTS];
+    int i, base, want_base = p->y;
+    int n = movegen_placements(b, p->type, list);
+    uint64_t want = _placement_cells(p->type, p->dir, p->x, &want_base);
+
+    for (i = 0; i < n; i ++)
+    {
+        base = list[i].y;
+        if (_placement_cells(list[i].type, list[i].dir, list[i].x, &base) == want && base == want_base)
+        {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+static unsigned long long int _perft(const struct tetris_board_t *b, const int *types, int depth, unsigned long long int *nodes)
+{
+    struct placement_t list[MAX_PLACEMENTS];
+    struct tetris_board_t next;
+    unsigned long long int leaves = 0;
+    int i, n = movegen_placements(b, types[0], list);
+
+    *nodes += n;
+    if (depth <= 1)
+    {
+        return n;
+    }
+
+    for (i = 0; i < n; i ++)
+    {
+        // Locked at spawn row, game over
+        if (list[i].y >= PLAYGROUND_HEIGHT - 4)
+        {
+            continue;
+        }
+
+        memcpy(&next, b, sizeof(struct tetris_board_t));
+        board_lock(&next, list[i].type, list[i].dir, list[i].x, list[i].y);
+        board_clear_lines(&next);
+        leaves += _perft(&next, types + 1, depth - 1, nodes);
+    }
+
+    return leaves;
+}
+
+// Leaves at depth N for given block sequence, nodes counts every generated placement
+unsigned long long int perft(const struct tetris_board_t *b, const int *types, int depth, unsigned long long int *nodes)
+{
+    *nodes = 0;
+    if (depth < 1)
+    {
+        return 1;
+    }
+
+    return _perft(b, types, depth, nodes);
+}
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
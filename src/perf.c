@@ -0,0 +1,195 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file perf.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ */
+
+#include <fcntl.h>
+#include "tetris.h"
+
+#define PERF_WINDOW_NS                  1000000000ULL
+
+// Cheap counters bumped from the simulation and render threads
+static struct
+{
+    unsigned long long int
+                        frames;
+    unsigned long long int
+                        render_ns;
+    unsigned long long int
+                        ticks;
+    unsigned long long int
+                        tick_ns;
+    uint32_t            tick_ring[PERF_RING];
+} perf;
+
+// Counters at the start of current window
+static struct
+{
+    uint64_t            at;
+    unsigned long long int
+                        frames;
+    unsigned long long int
+                        render_ns;
+    unsigned long long int
+                        ticks;
+    unsigned long long int
+                        tick_ns;
+    unsigned long long int
+                        wchar;
+    unsigned long long int
+                        io_calls;
+} window;
+
+static struct perf_report_t report;
+
+uint64_t perf_now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void perf_tick(uint64_t ns)
+{
+    perf.tick_ring[perf.ticks % PERF_RING] = (ns > 0xFFFFFFFF) ? 0xFFFFFFFF : ns;
+    __atomic_fetch_add(&perf.tick_ns, ns, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&perf.ticks, 1, __ATOMIC_RELEASE);
+
+    return;
+}
+
+void perf_frame(uint64_t ns)
+{
+    perf.render_ns += ns;
+    perf.frames ++;
+
+    return;
+}
+
+// Kernel keeps per process I/O accounting, one read a second is all we pay.
+// wchar is every byte the process wrote, syscr / syscw only count read and write calls
+static bool _perf_io(unsigned long long int *wchar, unsigned long long int *io_calls)
+{
+    static char buf[512];
+    unsigned long long int syscr = 0, syscw = 0;
+    int fd = open("/proc/self/io", O_RDONLY);
+    if (fd < 0)
+    {
+        return FALSE;
+    }
+
+    ssize_t r = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (r <= 0)
+    {
+        return FALSE;
+    }
+
+    buf[r] = 0;
+    char *p = strstr(buf, "wchar:");
+    char *q = strstr(buf, "syscr:");
+    char *w = strstr(buf, "syscw:");
+    if (p == NULL || q == NULL || w == NULL)
+    {
+        return FALSE;
+    }
+
+    *wchar = strtoull(p + 6, NULL, 10);
+    syscr = strtoull(q + 6, NULL, 10);
+    syscw = strtoull(w + 6, NULL, 10);
+    *io_calls = syscr + syscw;
+
+    return TRUE;
+}
+
+static int _perf_cmp(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+const struct perf_report_t * perf_report()
+{
+    static uint32_t sorted[PERF_RING];
+    uint64_t now = perf_now();
+    unsigned long long int wchar = 0, io_calls = 0;
+
+    if (now - window.at < PERF_WINDOW_NS)
+    {
+        return &report;
+    }
+
+    // Simulation thread keeps ticking, read its counters once
+    unsigned long long int ticks_total = __atomic_load_n(&perf.ticks, __ATOMIC_ACQUIRE);
+    unsigned long long int tick_ns = __atomic_load_n(&perf.tick_ns, __ATOMIC_RELAXED);
+    double seconds = (window.at > 0) ? (now - window.at) / 1e9 : 0;
+    unsigned long long int ticks = ticks_total - window.ticks;
+    unsigned long long int frames = perf.frames - window.frames;
+    bool io = _perf_io(&wchar, &io_calls);
+    if (seconds > 0)
+    {
+        report.fps = frames / seconds + 0.5;
+        report.tick_mean_us = ticks ? (tick_ns - window.tick_ns) / 1e3 / ticks : 0;
+        report.render_us = frames ? (perf.render_ns - window.render_ns) / 1e3 / frames : 0;
+        report.io = io && window.wchar > 0;
+        report.written_ps = report.io ? (wchar - window.wchar) / seconds : 0;
+        report.io_calls_ps = report.io ? (io_calls - window.io_calls) / seconds : 0;
+
+        // p99 of the latest ticks still in ring
+        unsigned int n = (ticks < PERF_RING) ? ticks : PERF_RING;
+        unsigned int i;
+        for (i = 0; i < n; i ++)
+        {
+            sorted[i] = perf.tick_ring[(ticks_total - 1 - i) % PERF_RING];
+        }
+
+        qsort(sorted, n, sizeof(uint32_t), _perf_cmp);
+        report.tick_p99_us = n ? sorted[(n * 99) / 100] / 1e3 : 0;
+    }
+
+    window.at = now;
+    window.frames = perf.frames;
+    window.render_ns = perf.render_ns;
+    window.ticks = ticks_total;
+    window.tick_ns = tick_ns;
+    window.wchar = wchar;
+    window.io_calls = io_calls;
+
+    return &report;
+}
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
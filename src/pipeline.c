@@ -0,0 +1,111 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file pipeline.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ */
+
+#include "tetris.h"
+
+// Set in middle slot index when it holds a snapshot the reader has not seen
+#define SNAPSHOT_FRESH                  4
+
+/* {{{ [Input ring] */
+bool input_push(struct input_ring_t *r, enum game_key_e key)
+{
+    unsigned int tail = r->tail;
+    if (tail - __atomic_load_n(&r->head, __ATOMIC_ACQUIRE) >= INPUT_RING)
+    {
+        return FALSE;
+    }
+
+    r->keys[tail % INPUT_RING] = key;
+    __atomic_store_n(&r->tail, tail + 1, __ATOMIC_RELEASE);
+
+    return TRUE;
+}
+
+enum game_key_e input_pop(struct input_ring_t *r)
+{
+    unsigned int head = r->head;
+    if (head == __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE))
+    {
+        return GAME_KEY_NONE;
+    }
+
+    enum game_key_e key = r->keys[head % INPUT_RING];
+    __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+
+    return key;
+}
+/* }}} */
+
+/* {{{ [Triple buffer] */
+void snapshot_init(struct snapshot_buffer_t *b, const struct tetris_scene_t *s)
+{
+    int i;
+    for (i = 0; i < 3; i ++)
+    {
+        memcpy(&b->slots[i], s, sizeof(struct tetris_scene_t));
+    }
+
+    b->back = 0;
+    b->middle = 1;
+    b->front = 2;
+
+    return;
+}
+
+// Writer owns back, swaps it with middle, never touches front
+void snapshot_publish(struct snapshot_buffer_t *b, const struct tetris_scene_t *s)
+{
+    memcpy(&b->slots[b->back], s, sizeof(struct tetris_scene_t));
+    b->back = __atomic_exchange_n(&b->middle, b->back | SNAPSHOT_FRESH, __ATOMIC_ACQ_REL) & 3;
+
+    return;
+}
+
+// Reader owns front, swaps it with middle only when middle is fresh
+struct tetris_scene_t * snapshot_acquire(struct snapshot_buffer_t *b)
+{
+    if (0 == (__atomic_load_n(&b->middle, __ATOMIC_ACQUIRE) & SNAPSHOT_FRESH))
+    {
+        return NULL;
+    }
+
+    b->front = __atomic_exchange_n(&b->middle, b->front, __ATOMIC_ACQ_REL) & 3;
+
+    return &b->slots[b->front];
+}
+/* }}} */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
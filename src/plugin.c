@@ -0,0 +1,195 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file plugin.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ */
+
+#include <dlfcn.h>
+#include "tetris.h"
+#include "tetris_bot.h"
+
+struct bot_plugin_t
+{
+    void               *dl;
+    void               *state;
+    tetris_bot_choose_f choose;
+    tetris_bot_free_f   free;
+    uint64_t            budget_ns;
+};
+
+struct bot_plugin_t * bot_plugin_open(const char *path, const char *args, uint64_t budget_ns)
+{
+    struct bot_plugin_t *p;
+    tetris_bot_init_f init;
+    tetris_bot_abi_f abi;
+    void *dl = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+
+    if (dl == NULL)
+    {
+        fprintf(stderr, "%s\n", dlerror());
+
+        return NULL;
+    }
+
+    abi = (tetris_bot_abi_f)dlsym(dl, "tetris_bot_abi");
+    if (abi != NULL && abi() != TETRIS_BOT_ABI)
+    {
+        fprintf(stderr, "%s : ABI %u, engine speaks %u\n", path, abi(), TETRIS_BOT_ABI);
+        dlclose(dl);
+
+        return NULL;
+    }
+
+    p = calloc(1, sizeof(struct bot_plugin_t));
+    if (p == NULL)
+    {
+        dlclose(dl);
+
+        return NULL;
+    }
+
+    p->dl = dl;
+    p->budget_ns = budget_ns;
+    p->choose = (tetris_bot_choose_f)dlsym(dl, "tetris_bot_choose");
+    p->free = (tetris_bot_free_f)dlsym(dl, "tetris_bot_free");
+    init = (tetris_bot_init_f)dlsym(dl, "tetris_bot_init");
+    if (p->choose == NULL || (init != NULL && 0 != init(args, &p->state)))
+    {
+        fprintf(stderr, "%s : %s\n", path, (p->choose == NULL) ? "no tetris_bot_choose" : "init failed");
+        dlclose(dl);
+        free(p);
+
+        return NULL;
+    }
+
+    return p;
+}
+
+// Ask plugin where the current block goes, -1 if it passed or answered something unreachable
+int bot_plugin_choose(struct bot_plugin_t *p, const struct tetris_scene_t *s, struct placement_t *placed)
+{
+    struct tetris_bot_view_t view;
+    struct tetris_bot_move_t move;
+    struct placement_t pl;
+
+    if (s->curr.type == BLOCK_UNKNOWN || STATUS_PLAYING != s->status)
+    {
+        return -1;
+    }
+
+    view.abi = TETRIS_BOT_ABI;
+    view.width = PLAYGROUND_WIDTH;
+    view.height = PLAYGROUND_HEIGHT;
+    view.rows = s->board.rows;
+    view.block_rows = (const uint16_t (*)[4][4])block_rows;
+    view.type = s->curr.type;
+    view.spawn_x = s->curr.pos.x;
+    view.spawn_y = s->curr.pos.y;
+    view.queue = s->queue.types;
+    view.queue_head = s->queue.head;
+    view.queue_len = s->queue.tail - s->queue.head;
+    view.queue_size = QUEUE_SIZE;
+    view.score = s->score;
+    view.lines = s->lines;
+    view.blocks = s->blocks;
+    view.budget_ns = p->budget_ns;
+
+    uint64_t begin = perf_now();
+    if (0 != p->choose(p->state, &view, &move))
+    {
+        return -1;
+    }
+
+    // Late or unreachable answers are ignored, block keeps falling
+    if (p->budget_ns > 0 && perf_now() - begin > p->budget_ns)
+    {
+        return -1;
+    }
+
+    // Range first, placement fields are narrower than the plugin's
+    if (move.x < -BOARD_PAD || move.x > PLAYGROUND_WIDTH || move.y < -BOARD_PAD || move.y >= PLAYGROUND_HEIGHT)
+    {
+        return -1;
+    }
+
+    pl.x = move.x;
+    pl.y = move.y;
+    pl.dir = move.dir & 3;
+    pl.type = s->curr.type;
+    if (move.dir < 0 || move.dir > 3 || !movegen_legal(&s->board, &pl))
+    {
+        return -1;
+    }
+
+    *placed = pl;
+
+    return 0;
+}
+
+// Ask plugin for current block and lock it there, events of the lock or 0 if plugin passed
+int bot_plugin_place(struct bot_plugin_t *p, struct tetris_scene_t *s, struct placement_t *placed)
+{
+    struct placement_t pl;
+
+    if (0 != bot_plugin_choose(p, s, &pl))
+    {
+        return 0;
+    }
+
+    if (placed != NULL)
+    {
+        *placed = pl;
+    }
+
+    return game_place(s, &pl);
+}
+
+void bot_plugin_close(struct bot_plugin_t *p)
+{
+    if (p == NULL)
+    {
+        return;
+    }
+
+    if (p->free != NULL)
+    {
+        p->free(p->state);
+    }
+
+    dlclose(p->dl);
+    free(p);
+
+    return;
+}
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
@@ -0,0 +1,189 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file queue.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ */
+
+#include "tetris.h"
+
+static const char *randomizer_names[] = {"uniform", "bag", "history"};
+
+void queue_init(struct tetris_queue_t *q)
+{
+    memset(q, 0, sizeof(struct tetris_queue_t));
+
+    // TGM starts from a history of S / Z, so no S, Z or O comes first
+    q->history[0] = BLOCK_Z;
+    q->history[1] = BLOCK_S;
+    q->history[2] = BLOCK_Z;
+    q->history[3] = BLOCK_S;
+    q->first = TRUE;
+
+    return;
+}
+
+static inline void _queue_push(struct tetris_queue_t *q, int type, uint64_t *rng)
+{
+    q->types[q->tail % QUEUE_SIZE] = type;
+    q->colors[q->tail % QUEUE_SIZE] = (rng_next(rng) % 6) + 25;
+    q->tail ++;
+
+    return;
+}
+
+static bool _queue_in_history(struct tetris_queue_t *q, int type)
+{
+    int i;
+    for (i = 0; i < TGM_HISTORY; i ++)
+    {
+        if (q->history[i] == type)
+        {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+// One batch of blocks from the generator
+static void _queue_batch(struct tetris_queue_t *q, enum randomizer_e randomizer, uint64_t *rng)
+{
+    int i, j, t, roll;
+    switch (randomizer)
+    {
+        case RANDOMIZER_BAG:
+        {
+            // Shuffled set of all seven
+            unsigned char bag[7] = {BLOCK_L, BLOCK_S, BLOCK_J, BLOCK_I, BLOCK_Z, BLOCK_O, BLOCK_T};
+            for (i = 6; i > 0; i --)
+            {
+                j = rng_next(rng) % (i + 1);
+                t = bag[i];
+                bag[i] = bag[j];
+                bag[j] = t;
+            }
+
+            for (i = 0; i < 7; i ++)
+            {
+                _queue_push(q, bag[i], rng);
+            }
+
+            break;
+        }
+        case RANDOMIZER_HISTORY:
+            // Reroll a few times against the last four blocks
+            for (i = 0; i < QUEUE_BATCH; i ++)
+            {
+                t = (rng_next(rng) % 7) + 1;
+                for (roll = 1; roll < TGM_ROLLS && _queue_in_history(q, t); roll ++)
+                {
+                    t = (rng_next(rng) % 7) + 1;
+                }
+
+                while (q->first && (t == BLOCK_S || t == BLOCK_Z || t == BLOCK_O))
+                {
+                    t = (rng_next(rng) % 7) + 1;
+                }
+
+                q->first = FALSE;
+                memmove(q->history, q->history + 1, TGM_HISTORY - 1);
+                q->history[TGM_HISTORY - 1] = t;
+                _queue_push(q, t, rng);
+            }
+
+            break;
+        case RANDOMIZER_UNIFORM:
+        default:
+            for (i = 0; i < QUEUE_BATCH; i ++)
+            {
+                _queue_push(q, (rng_next(rng) % 7) + 1, rng);
+            }
+
+            break;
+    }
+
+    return;
+}
+
+void queue_fill(struct tetris_queue_t *q, enum randomizer_e randomizer, uint64_t *rng, int keep)
+{
+    while (q->tail - q->head <= (unsigned int)keep)
+    {
+        _queue_batch(q, randomizer, rng);
+    }
+
+    return;
+}
+
+int queue_pop(struct tetris_queue_t *q, int *color)
+{
+    if (q->tail == q->head)
+    {
+        return BLOCK_UNKNOWN;
+    }
+
+    *color = q->colors[q->head % QUEUE_SIZE];
+
+    return q->types[q->head ++ % QUEUE_SIZE];
+}
+
+int queue_peek(const struct tetris_queue_t *q, int i, int *color)
+{
+    if (q->head + i >= q->tail)
+    {
+        return BLOCK_UNKNOWN;
+    }
+
+    if (color != NULL)
+    {
+        *color = q->colors[(q->head + i) % QUEUE_SIZE];
+    }
+
+    return q->types[(q->head + i) % QUEUE_SIZE];
+}
+
+int randomizer_by_name(const char *name)
+{
+    int i;
+    for (i = 0; i < sizeof(randomizer_names) / sizeof(char *); i ++)
+    {
+        if (0 == strcmp(name, randomizer_names[i]))
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
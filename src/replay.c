@@ -0,0 +1,526 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file replay.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ */
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "tetris.h"
+
+/*
+ * Replay file :
+ *     header
+ *     records, 8 bytes each : key before tick / placement after tick / keyframe
+ *         a keyframe record is followed by the raw scene at the end of its tick
+ *     index of keyframes (piece, tick, offset)
+ *     footer, points at index
+ *
+ * The first keyframe is the scene before the first tick, so a file is playable
+ * from start even if the game died before the index was written.
+ */
+struct replay_writer_t
+{
+    FILE               *fp;
+    int                 keyframe;
+    uint32_t            count;
+    uint32_t            capacity;
+    struct replay_index_t
+                       *index;
+};
+
+struct replay_t
+{
+    const unsigned char
+                       *data;
+    size_t              size;
+    size_t              end;
+    const struct replay_header_t
+                       *header;
+    struct replay_index_t
+                       *index;
+    uint32_t            count;
+    uint32_t            blocks;
+    uint64_t            end_tick;
+};
+
+static void _replay_record(struct replay_writer_t *w, uint32_t tick, char kind, int x, int y, int v)
+{
+    struct replay_event_t e;
+
+    e.tick = tick;
+    e.kind = kind;
+    e.x = x;
+    e.y = y;
+    e.v = v;
+    fwrite(&e, sizeof(e), 1, w->fp);
+
+    return;
+}
+
+static void _replay_keyframe(struct replay_writer_t *w, const struct tetris_scene_t *s)
+{
+    if (w->count == w->capacity)
+    {
+        uint32_t capacity = w->capacity ? w->capacity * 2 : 64;
+        struct replay_index_t *index = realloc(w->index, sizeof(struct replay_index_t) * capacity);
+        if (index == NULL)
+        {
+            return;
+        }
+
+        w->index = index;
+        w->capacity = capacity;
+    }
+
+    w->index[w->count].blocks = s->blocks;
+    w->index[w->count].tick = s->timer_counter;
+    w->index[w->count].offset = ftell(w->fp);
+    w->count ++;
+    _replay_record(w, s->timer_counter, REPLAY_KEYFRAME, 0, 0, 0);
+    fwrite(s, sizeof(struct tetris_scene_t), 1, w->fp);
+
+    return;
+}
+
+struct replay_writer_t * replay_create(const char *path, const struct tetris_scene_t *s, int keyframe)
+{
+    struct replay_header_t header;
+    struct replay_writer_t *w = calloc(1, sizeof(struct replay_writer_t));
+
+    if (w == NULL)
+    {
+        return NULL;
+    }
+
+    if (NULL == (w->fp = fopen(path, "wb")))
+    {
+        free(w);
+
+        return NULL;
+    }
+
+    // Keys come in at human pace, a large buffer keeps writes off the tick path
+    setvbuf(w->fp, NULL, _IOFBF, 1 << 16);
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, REPLAY_MAGIC, 8);
+    header.version = REPLAY_VERSION;
+    header.scene_size = sizeof(struct tetris_scene_t);
+    header.keyframe = (keyframe > 0) ? keyframe : REPLAY_KEYFRAME_BLOCKS;
+    fwrite(&header, sizeof(header), 1, w->fp);
+    w->keyframe = header.keyframe;
+    _replay_keyframe(w, s);
+
+    return w;
+}
+
+void replay_key(struct replay_writer_t *w, uint32_t tick, enum game_key_e key)
+{
+    _replay_record(w, tick, REPLAY_KEY, 0, 0, key);
+
+    return;
+}
+
+void replay_place(struct replay_writer_t *w, uint32_t tick, const struct placement_t *p)
+{
+    _replay_record(w, tick, REPLAY_PLACE, p->x, p->y, p->dir);
+
+    return;
+}
+
+// End of a tick, keyframe on every N-th spawn
+void replay_tick(struct replay_writer_t *w, const struct tetris_scene_t *s, int ev)
+{
+    if ((ev & EVENT_SPAWN) && 0 == s->blocks % w->keyframe)
+    {
+        _replay_keyframe(w, s);
+    }
+
+    return;
+}
+
+int replay_finish(struct replay_writer_t *w, const struct tetris_scene_t *s)
+{
+    struct replay_footer_t footer;
+    int ret = 0;
+
+    // Final state closes the recording, verifiers check against it
+    if (0 == w->count || w->index[w->count - 1].tick != s->timer_counter)
+    {
+        _replay_keyframe(w, s);
+    }
+
+    memset(&footer, 0, sizeof(footer));
+    footer.index_offset = ftell(w->fp);
+    footer.count = w->count;
+    footer.blocks = s->blocks;
+    footer.end_tick = s->timer_counter;
+    memcpy(footer.magic, REPLAY_INDEX_MAGIC, 8);
+    if (w->count != fwrite(w->index, sizeof(struct replay_index_t), w->count, w->fp) ||
+        1 != fwrite(&footer, sizeof(footer), 1, w->fp))
+    {
+        ret = -1;
+    }
+
+    if (0 != fclose(w->fp))
+    {
+        ret = -1;
+    }
+
+    free(w->index);
+    free(w);
+
+    return ret;
+}
+
+// No footer, game died while recording. Walk records once to find keyframes
+static int _replay_scan(struct replay_t *r)
+{
+    size_t pos = sizeof(struct replay_header_t), step;
+    uint32_t capacity = 0;
+
+    r->count = 0;
+    r->index = NULL;
+    while (pos + sizeof(struct replay_event_t) <= r->size)
+    {
+        const struct replay_event_t *e = (const void *)(r->data + pos);
+        step = sizeof(struct replay_event_t);
+        if (REPLAY_KEYFRAME == e->kind)
+        {
+            const struct tetris_scene_t *s = (const void *)(r->data + pos + step);
+            step += r->header->scene_size;
+            if (pos + step > r->size)
+            {
+                break;
+            }
+
+            if (r->count == capacity)
+            {
+                capacity = capacity ? capacity * 2 : 64;
+                struct replay_index_t *index = realloc(r->index, sizeof(struct replay_index_t) * capacity);
+                if (index == NULL)
+                {
+                    return -1;
+                }
+
+                r->index = index;
+            }
+
+            r->index[r->count].blocks = s->blocks;
+            r->index[r->count].tick = e->tick;
+            r->index[r->count].offset = pos;
+            r->count ++;
+        }
+
+        // Keyframe carries the tick after it, events the tick they apply in
+        r->end_tick = e->tick + ((REPLAY_KEYFRAME == e->kind) ? 0 : 1);
+        pos += step;
+    }
+
+    r->end = pos;
+
+    return (r->count > 0) ? 0 : -1;
+}
+
+// Seeking trusts the index, every entry must point at a whole keyframe in order
+static int _replay_index_check(const struct replay_t *r)
+{
+    size_t frame = sizeof(struct replay_event_t) + r->header->scene_size;
+    uint32_t i;
+    for (i = 0; i < r->count; i ++)
+    {
+        const struct replay_index_t *k = &r->index[i];
+        if (k->offset < sizeof(struct replay_header_t) || r->end < frame || k->offset > r->end - frame ||
+            REPLAY_KEYFRAME != ((const struct replay_event_t *)(r->data + k->offset))->kind)
+        {
+            return -1;
+        }
+
+        if (i > 0 && (k->blocks < k[-1].blocks || k->tick < k[-1].tick))
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+struct replay_t * replay_open(const char *path)
+{
+    const struct replay_footer_t *footer;
+    struct tetris_scene_t tail;
+    struct replay_t *r;
+    struct stat st;
+    int fd;
+
+    if (0 > (fd = open(path, O_RDONLY)))
+    {
+        return NULL;
+    }
+
+    if (0 != fstat(fd, &st) || st.st_size < sizeof(struct replay_header_t) || NULL == (r = calloc(1, sizeof(struct replay_t))))
+    {
+        close(fd);
+
+        return NULL;
+    }
+
+    r->size = st.st_size;
+    r->data = mmap(NULL, r->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (MAP_FAILED == r->data)
+    {
+        free(r);
+
+        return NULL;
+    }
+
+    r->header = (const void *)r->data;
+    if (0 != memcmp(r->header->magic, REPLAY_MAGIC, 8) || REPLAY_VERSION != r->header->version ||
+        sizeof(struct tetris_scene_t) != r->header->scene_size)
+    {
+        replay_close(r);
+
+        return NULL;
+    }
+
+    footer = (const void *)(r->data + r->size - sizeof(struct replay_footer_t));
+    if (r->size >= sizeof(struct replay_header_t) + sizeof(struct replay_footer_t) &&
+        0 == memcmp(footer->magic, REPLAY_INDEX_MAGIC, 8) &&
+        footer->index_offset >= sizeof(struct replay_header_t) &&
+        footer->index_offset <= r->size - sizeof(struct replay_footer_t) &&
+        r->size - sizeof(struct replay_footer_t) - footer->index_offset == sizeof(struct replay_index_t) * (uint64_t)footer->count &&
+        footer->count > 0)
+    {
+        r->count = footer->count;
+        r->index = malloc(sizeof(struct replay_index_t) * r->count);
+        if (r->index == NULL)
+        {
+            replay_close(r);
+
+            return NULL;
+        }
+
+        memcpy(r->index, r->data + footer->index_offset, sizeof(struct replay_index_t) * r->count);
+        r->end = footer->index_offset;
+        r->blocks = footer->blocks;
+        r->end_tick = footer->end_tick;
+        if (0 != _replay_index_check(r))
+        {
+            replay_close(r);
+
+            return NULL;
+        }
+
+        return r;
+    }
+
+    if (0 != _replay_scan(r))
+    {
+        replay_close(r);
+
+        return NULL;
+    }
+
+    // Pieces after the last keyframe are only known by playing them
+    r->blocks = r->index[r->count - 1].blocks;
+    r->blocks = replay_seek(r, INT_MAX, &tail);
+
+    return r;
+}
+
+void replay_close(struct replay_t *r)
+{
+    if (r == NULL)
+    {
+        return;
+    }
+
+    munmap((void *)r->data, r->size);
+    free(r->index);
+    free(r);
+
+    return;
+}
+
+int replay_blocks(const struct replay_t *r)
+{
+    return r->blocks;
+}
+
+int replay_keyframe_interval(const struct replay_t *r)
+{
+    return r->header->keyframe;
+}
+
+// Next key or placement record, keyframes only matter for seeking
+static inline const struct replay_event_t * _replay_event(const struct replay_t *r, size_t *pos)
+{
+    const struct replay_event_t *e;
+    while (*pos < r->end && REPLAY_KEYFRAME == (e = (const void *)(r->data + *pos))->kind)
+    {
+        *pos += sizeof(struct replay_event_t) + r->header->scene_size;
+    }
+
+    return (*pos < r->end) ? (const void *)(r->data + *pos) : NULL;
+}
+
+const struct replay_event_t * replay_next(const struct replay_t *r, size_t *cursor)
+{
+    const struct replay_event_t *e;
+
+    if (*cursor < sizeof(struct replay_header_t))
+    {
+        *cursor = sizeof(struct replay_header_t);
+    }
+
+    if (NULL != (e = _replay_event(r, cursor)))
+    {
+        *cursor += sizeof(struct replay_event_t);
+    }
+
+    return e;
+}
+
+// Play records from offset until the tick in which block n spawned, tick until, or the recording ends
+static size_t _replay_run(const struct replay_t *r, size_t pos, int block, uint64_t until, struct tetris_scene_t *s)
+{
+    const struct replay_event_t *e;
+    struct placement_t p;
+    int ev;
+
+    while (s->timer_counter < until)
+    {
+        uint32_t tick = s->timer_counter;
+        while (NULL != (e = _replay_event(r, &pos)) && e->tick == tick && REPLAY_KEY == e->kind)
+        {
+            game_input(s, e->v);
+            pos += sizeof(struct replay_event_t);
+        }
+
+        ev = game_tick(s);
+        while (NULL != (e = _replay_event(r, &pos)) && e->tick == tick && REPLAY_PLACE == e->kind)
+        {
+            p.x = e->x;
+            p.y = e->y;
+            p.dir = e->v;
+            p.type = s->curr.type;
+            ev |= game_place(s, &p);
+            pos += sizeof(struct replay_event_t);
+        }
+
+        if ((ev & EVENT_END) || ((ev & EVENT_SPAWN) && s->blocks >= block))
+        {
+            break;
+        }
+    }
+
+    return pos;
+}
+
+// What a keyframe is checked by, window size and such are not part of the game
+static uint32_t _replay_checksum(const struct tetris_scene_t *s)
+{
+    uint32_t h = s->replay_hash;
+    int i;
+    for (i = 0; i < PLAYGROUND_HEIGHT; i ++)
+    {
+        h = (h ^ s->board.rows[i]) * 16777619u;
+    }
+
+    h = (h ^ (uint32_t)s->score) * 16777619u;
+    h = (h ^ (uint32_t)s->blocks) * 16777619u;
+    h = (h ^ (uint32_t)s->rng) * 16777619u;
+
+    return h;
+}
+
+// Scene at end of the tick block n spawned in : nearest keyframe, then at most one interval simulated
+int replay_seek(const struct replay_t *r, int block, struct tetris_scene_t *s)
+{
+    uint32_t lo = 0, hi = r->count;
+
+    // Last keyframe at or before block
+    while (hi - lo > 1)
+    {
+        uint32_t mid = (lo + hi) / 2;
+        if (r->index[mid].blocks <= block)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    size_t pos = r->index[lo].offset;
+    memcpy(s, r->data + pos + sizeof(struct replay_event_t), sizeof(struct tetris_scene_t));
+    if (s->blocks < block)
+    {
+        _replay_run(r, pos + sizeof(struct replay_event_t) + r->header->scene_size, block, r->end_tick, s);
+    }
+
+    return s->blocks;
+}
+
+// Whole recording from the first keyframe, every later keyframe must match : 0, or the first one that does not
+int replay_verify(const struct replay_t *r, struct tetris_scene_t *s)
+{
+    const struct tetris_scene_t *keyframe;
+    uint64_t end;
+    size_t pos = r->index[0].offset + sizeof(struct replay_event_t);
+    uint32_t k;
+
+    memcpy(s, r->data + pos, sizeof(struct tetris_scene_t));
+    pos += r->header->scene_size;
+    for (k = 1; k < r->count; k ++)
+    {
+        // Topping out does not advance the clock, a finished game also plays its last tick
+        keyframe = (const void *)(r->data + r->index[k].offset + sizeof(struct replay_event_t));
+        end = (STATUS_OVER == keyframe->status || STATUS_EGG == keyframe->status) ? r->index[k].tick + 1 : r->index[k].tick;
+        pos = _replay_run(r, pos, INT_MAX, end, s);
+        if (s->timer_counter != r->index[k].tick || _replay_checksum(s) != _replay_checksum(keyframe))
+        {
+            return k;
+        }
+    }
+
+    _replay_run(r, pos, INT_MAX, r->end_tick, s);
+
+    return 0;
+}
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
@@ -0,0 +1,567 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file scores.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "tetris.h"
+
+#define SCORES_LOG                      "scores.log"
+#define SCORES_INDEX                    "scores.idx"
+#define SCORES_INDEX_MAGIC              "tscidx1"
+
+/*
+ * scores.log holds fixed size records, only ever appended. A torn record
+ * at the end is cut off on open, a record failing its check is skipped.
+ *
+ * scores.idx covers the first `covered` records of the log with three
+ * sorted views of the same entries : by score, by level then score, by
+ * player then score. It is rebuilt into a temporary file and renamed over
+ * the old one, so readers see either index whole. Records appended since
+ * are the tail, scanned at query time and folded into the index once the
+ * tail grows past SCORES_TAIL_MAX.
+ */
+struct score_entry_t
+{
+    int32_t             score;
+    int32_t             level;
+    uint32_t            player;
+    uint32_t            record;
+};
+
+struct score_index_t
+{
+    char                magic[8];
+    uint64_t            covered;
+    uint64_t            entries;
+    uint64_t            reserved;
+    struct score_entry_t
+                        views[];
+};
+
+struct score_db_t
+{
+    char                dir[PATH_MAX];
+    int                 log_fd;
+    const struct score_record_t
+                       *log;
+    size_t              log_size;
+    const struct score_index_t
+                       *idx;
+    size_t              idx_size;
+};
+
+static uint32_t _scores_fnv(const void *p, size_t len)
+{
+    const unsigned char *c = p;
+    uint32_t h = 2166136261u;
+    size_t i;
+    for (i = 0; i < len; i ++)
+    {
+        h = (h ^ c[i]) * 16777619u;
+    }
+
+    return h;
+}
+
+static inline bool _scores_valid(const struct score_record_t *r)
+{
+    return r->check == _scores_fnv(r, offsetof(struct score_record_t, check));
+}
+
+// Names are stored to SCORE_PLAYER - 1 characters, queries are cut the same way
+static inline uint32_t _scores_player(const char *name)
+{
+    return _scores_fnv(name, strnlen(name, SCORE_PLAYER - 1));
+}
+
+static inline size_t _scores_records(const struct score_db_t *db)
+{
+    return db->log_size / sizeof(struct score_record_t);
+}
+
+static inline size_t _scores_covered(const struct score_db_t *db)
+{
+    return (db->idx != NULL) ? db->idx->covered : 0;
+}
+
+// Follow appends of this and other processes
+static int _scores_map_log(struct score_db_t *db)
+{
+    struct stat st;
+    if (0 != fstat(db->log_fd, &st))
+    {
+        return -1;
+    }
+
+    size_t size = st.st_size - st.st_size % sizeof(struct score_record_t);
+    if (size == db->log_size)
+    {
+        return 0;
+    }
+
+    if (db->log != NULL)
+    {
+        munmap((void *)db->log, db->log_size);
+        db->log = NULL;
+        db->log_size = 0;
+    }
+
+    if (size > 0)
+    {
+        void *p = mmap(NULL, size, PROT_READ, MAP_SHARED, db->log_fd, 0);
+        if (MAP_FAILED == p)
+        {
+            return -1;
+        }
+
+        db->log = p;
+        db->log_size = size;
+    }
+
+    return 0;
+}
+
+// Queries read the log at every entry's record, each one must be a covered record
+static bool _scores_index_valid(const struct score_index_t *idx)
+{
+    size_t i;
+    for (i = 0; i < 3 * idx->entries; i ++)
+    {
+        if (idx->views[i].record >= idx->covered)
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+// Index that does not fit the log is ignored, next rebuild replaces it
+static void _scores_map_index(struct score_db_t *db)
+{
+    char path[PATH_MAX];
+    struct stat st;
+    int fd;
+
+    if (db->idx != NULL)
+    {
+        munmap((void *)db->idx, db->idx_size);
+        db->idx = NULL;
+        db->idx_size = 0;
+    }
+
+    if (snprintf(path, sizeof(path), "%s/%s", db->dir, SCORES_INDEX) >= (int)sizeof(path) || 0 > (fd = open(path, O_RDONLY)))
+    {
+        return;
+    }
+
+    if (0 == fstat(fd, &st) && st.st_size >= sizeof(struct score_index_t))
+    {
+        void *p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        const struct score_index_t *idx = p;
+        if (MAP_FAILED != p)
+        {
+            if (0 == memcmp(idx->magic, SCORES_INDEX_MAGIC, 8) &&
+                idx->covered <= _scores_records(db) &&
+                idx->entries <= idx->covered &&
+                st.st_size == sizeof(struct score_index_t) + 3 * idx->entries * sizeof(struct score_entry_t) &&
+                _scores_index_valid(idx))
+            {
+                db->idx = idx;
+                db->idx_size = st.st_size;
+            }
+            else
+            {
+                munmap(p, st.st_size);
+            }
+        }
+    }
+
+    close(fd);
+
+    return;
+}
+
+struct score_db_t * scores_open(const char *dir)
+{
+    char path[PATH_MAX];
+    struct stat st;
+    struct score_db_t *db;
+
+    if (0 != mkdir(dir, 0755) && EEXIST != errno)
+    {
+        return NULL;
+    }
+
+    if (NULL == (db = calloc(1, sizeof(struct score_db_t))))
+    {
+        return NULL;
+    }
+
+    snprintf(db->dir, sizeof(db->dir), "%s", dir);
+    snprintf(path, sizeof(path), "%s/%s", dir, SCORES_LOG);
+    db->log_fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (db->log_fd < 0)
+    {
+        free(db);
+
+        return NULL;
+    }
+
+    // Crash in the middle of an append, drop the partial record
+    if (0 == fstat(db->log_fd, &st) && 0 != st.st_size % sizeof(struct score_record_t))
+    {
+        if (0 != ftruncate(db->log_fd, st.st_size - st.st_size % sizeof(struct score_record_t)))
+        {
+            perror("ftruncate");
+        }
+    }
+
+    if (0 != _scores_map_log(db))
+    {
+        scores_close(db);
+
+        return NULL;
+    }
+
+    _scores_map_index(db);
+
+    return db;
+}
+
+void scores_close(struct score_db_t *db)
+{
+    if (db == NULL)
+    {
+        return;
+    }
+
+    if (db->idx != NULL)
+    {
+        munmap((void *)db->idx, db->idx_size);
+    }
+
+    if (db->log != NULL)
+    {
+        munmap((void *)db->log, db->log_size);
+    }
+
+    close(db->log_fd);
+    free(db);
+
+    return;
+}
+
+void scores_record(const struct tetris_scene_t *s, const char *player, struct score_record_t *r)
+{
+    unsigned long long int ticks = 0;
+    int i;
+
+    memset(r, 0, sizeof(struct score_record_t));
+    strncpy(r->player, player, SCORE_PLAYER - 1);
+    r->score = s->score;
+    r->blocks = s->blocks;
+    r->level = s->level;
+    r->lines = s->lines;
+    r->seed = s->config.seed;
+    for (i = 0; i <= MAX_TETRIS_LEVEL; i ++)
+    {
+        ticks += s->stats.level_ticks[i];
+    }
+
+    r->duration_ms = ticks * (SIM_PERIOD_NS / 1000000);
+    r->replay = s->replay_hash;
+    r->time = time(NULL);
+
+    return;
+}
+
+int scores_append(struct score_db_t *db, struct score_record_t *r, int n)
+{
+    size_t bytes = sizeof(struct score_record_t) * n;
+    int i;
+
+    for (i = 0; i < n; i ++)
+    {
+        r[i].check = _scores_fnv(&r[i], offsetof(struct score_record_t, check));
+    }
+
+    // O_APPEND keeps concurrent games from interleaving records, batches go in one write
+    if (bytes != write(db->log_fd, r, bytes))
+    {
+        return -1;
+    }
+
+    if (0 != fsync(db->log_fd) || 0 != _scores_map_log(db))
+    {
+        return -1;
+    }
+
+    if (_scores_records(db) - _scores_covered(db) > SCORES_TAIL_MAX)
+    {
+        return scores_rebuild(db);
+    }
+
+    return 0;
+}
+
+static int _scores_by_score(const void *a, const void *b)
+{
+    const struct score_entry_t *x = a, *y = b;
+    if (x->score != y->score)
+    {
+        return (x->score > y->score) ? -1 : 1;
+    }
+
+    return (x->record > y->record) - (x->record < y->record);
+}
+
+static int _scores_by_level(const void *a, const void *b)
+{
+    const struct score_entry_t *x = a, *y = b;
+    if (x->level != y->level)
+    {
+        return (x->level > y->level) - (x->level < y->level);
+    }
+
+    return _scores_by_score(a, b);
+}
+
+static int _scores_by_player(const void *a, const void *b)
+{
+    const struct score_entry_t *x = a, *y = b;
+    if (x->player != y->player)
+    {
+        return (x->player > y->player) - (x->player < y->player);
+    }
+
+    return _scores_by_score(a, b);
+}
+
+int scores_rebuild(struct score_db_t *db)
+{
+    struct score_index_t header;
+    struct score_entry_t *views;
+    char path[PATH_MAX], tmp[PATH_MAX];
+    size_t i, n, total;
+    int fd, ret = -1;
+
+    if (0 != _scores_map_log(db) ||
+        snprintf(path, sizeof(path), "%s/%s", db->dir, SCORES_INDEX) >= (int)sizeof(path) ||
+        snprintf(tmp, sizeof(tmp), "%s/%s.%d", db->dir, SCORES_INDEX, getpid()) >= (int)sizeof(tmp))
+    {
+        return -1;
+    }
+
+    total = _scores_records(db);
+    views = malloc(sizeof(struct score_entry_t) * 3 * (total ? total : 1));
+    if (views == NULL)
+    {
+        return -1;
+    }
+
+    for (i = 0, n = 0; i < total; i ++)
+    {
+        const struct score_record_t *r = &db->log[i];
+        if (!_scores_valid(r))
+        {
+            continue;
+        }
+
+        views[n].score = r->score;
+        views[n].level = r->level;
+        views[n].player = _scores_player(r->player);
+        views[n].record = i;
+        n ++;
+    }
+
+    memcpy(views + n, views, sizeof(struct score_entry_t) * n);
+    memcpy(views + n * 2, views, sizeof(struct score_entry_t) * n);
+    qsort(views, n, sizeof(struct score_entry_t), _scores_by_score);
+    qsort(views + n, n, sizeof(struct score_entry_t), _scores_by_level);
+    qsort(views + n * 2, n, sizeof(struct score_entry_t), _scores_by_player);
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SCORES_INDEX_MAGIC, 8);
+    header.covered = total;
+    header.entries = n;
+
+    // Replace atomically, readers keep whichever index they mapped
+    fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0)
+    {
+        size_t bytes = sizeof(struct score_entry_t) * 3 * n;
+        if (sizeof(header) == write(fd, &header, sizeof(header)) &&
+            bytes == write(fd, views, bytes) &&
+            0 == fsync(fd))
+        {
+            ret = 0;
+        }
+
+        close(fd);
+        if (0 == ret && 0 != rename(tmp, path))
+        {
+            ret = -1;
+        }
+
+        if (0 != ret)
+        {
+            unlink(tmp);
+        }
+    }
+
+    free(views);
+    if (0 == ret)
+    {
+        _scores_map_index(db);
+    }
+
+    return ret;
+}
+
+// First entry of a view not ordered before key, view sorted by cmp
+static size_t _scores_lower(const struct score_entry_t *view, size_t n, const struct score_entry_t *key, int (*cmp)(const void *, const void *))
+{
+    size_t lo = 0, hi = n;
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+        if (cmp(&view[mid], key) < 0)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+static inline bool _scores_match(const struct score_record_t *r, int level, const char *player)
+{
+    return (level < 0 || r->level == level) && (player == NULL || 0 == strncmp(r->player, player, SCORE_PLAYER - 1));
+}
+
+int scores_query(struct score_db_t *db, int level, const char *player, int k, struct score_record_t *out)
+{
+    const struct score_entry_t *view = NULL;
+    struct score_entry_t key;
+    size_t i, start = 0, n = 0, covered, total;
+    int found = 0, j;
+
+    memset(&key, 0, sizeof(struct score_entry_t));
+
+    if (k <= 0 || 0 != _scores_map_log(db))
+    {
+        return 0;
+    }
+
+    covered = _scores_covered(db);
+    total = _scores_records(db);
+
+    // Indexed part, walk the view whose order matches the filter
+    if (db->idx != NULL)
+    {
+        n = db->idx->entries;
+        key.score = INT32_MAX;
+        key.record = 0;
+        if (player != NULL)
+        {
+            view = db->idx->views + n * 2;
+            key.player = _scores_player(player);
+            start = _scores_lower(view, n, &key, _scores_by_player);
+        }
+        else if (level >= 0)
+        {
+            view = db->idx->views + n;
+            key.level = level;
+            start = _scores_lower(view, n, &key, _scores_by_level);
+        }
+        else
+        {
+            view = db->idx->views;
+        }
+
+        for (i = start; i < n && found < k; i ++)
+        {
+            if ((player != NULL && view[i].player != key.player) || (player == NULL && level >= 0 && view[i].level != level))
+            {
+                break;
+            }
+
+            const struct score_record_t *r = &db->log[view[i].record];
+            if (_scores_match(r, level, player))
+            {
+                out[found ++] = *r;
+            }
+        }
+    }
+
+    // Unindexed tail, newer than everything above so ties stay behind
+    for (i = covered; i < total; i ++)
+    {
+        const struct score_record_t *r = &db->log[i];
+        if (!_scores_valid(r) || !_scores_match(r, level, player))
+        {
+            continue;
+        }
+
+        if (found == k && r->score <= out[k - 1].score)
+        {
+            continue;
+        }
+
+        for (j = (found < k) ? found : k - 1; j > 0 && out[j - 1].score < r->score; j --)
+        {
+            out[j] = out[j - 1];
+        }
+
+        out[j] = *r;
+        if (found < k)
+        {
+            found ++;
+        }
+    }
+
+    return found;
+}
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
@@ -0,0 +1,131 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file shm.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include "tetris.h"
+#include "tetris_shm.h"
+
+static struct tetris_shm_t *shm = NULL;
+static char shm_name[256];
+
+int shm_export_open(const char *name)
+{
+    int fd;
+
+    // POSIX names start with one slash
+    snprintf(shm_name, sizeof(shm_name), "%s%s", ('/' == name[0]) ? "" : "/", name);
+    fd = shm_open(shm_name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    if (0 != ftruncate(fd, sizeof(struct tetris_shm_t)))
+    {
+        close(fd);
+        shm_unlink(shm_name);
+
+        return -1;
+    }
+
+    shm = mmap(NULL, sizeof(struct tetris_shm_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED == shm)
+    {
+        shm = NULL;
+        shm_unlink(shm_name);
+
+        return -1;
+    }
+
+    memset(shm, 0, sizeof(struct tetris_shm_t));
+    shm->version = TETRIS_SHM_VERSION;
+    shm->pid = getpid();
+    shm->width = PLAYGROUND_WIDTH;
+    shm->height = PLAYGROUND_HEIGHT;
+
+    // Readers check magic last, segment is complete once it shows up
+    __atomic_store_n(&shm->magic, TETRIS_SHM_MAGIC, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+// Seqlock writer, single writer so a plain increment pair is enough
+void shm_export_publish(const struct tetris_scene_t *s)
+{
+    if (shm == NULL)
+    {
+        return;
+    }
+
+    uint32_t seq = shm->seq;
+    __atomic_store_n(&shm->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    memcpy(shm->rows, s->board.rows, sizeof(s->board.rows));
+    shm->type = s->curr.type;
+    shm->dir = s->curr.direction;
+    shm->x = s->curr.pos.x;
+    shm->y = s->curr.pos.y;
+    shm->score = s->score;
+    shm->level = s->level;
+    shm->blocks = s->blocks;
+    shm->lines = s->lines;
+    shm->status = s->status;
+    shm->updates ++;
+    shm->tick = s->timer_counter;
+
+    __atomic_store_n(&shm->seq, seq + 2, __ATOMIC_RELEASE);
+
+    return;
+}
+
+void shm_export_close()
+{
+    if (shm == NULL)
+    {
+        return;
+    }
+
+    munmap(shm, sizeof(struct tetris_shm_t));
+    shm_unlink(shm_name);
+    shm = NULL;
+
+    return;
+}
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
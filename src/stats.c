@@ -0,0 +1,161 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file stats.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ */
+
+#include <strings.h>
+#include "tetris.h"
+
+// Game time, 10ms per tick
+#define STATS_TICK_SECONDS              0.01
+
+static const char *stats_piece_names[8] = {"-", "L", "S", "J", "I", "Z", "O", "T"};
+
+static void _stats_json(FILE *fp, struct tetris_scene_t *s, double seconds)
+{
+    const struct tetris_stats_t *st = &s->stats;
+    int i;
+
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"version\": \"%s\",\n", APP_VERSION);
+    fprintf(fp, "  \"seconds\": %.2f,\n", seconds);
+    fprintf(fp, "  \"score\": %d,\n", s->score);
+    fprintf(fp, "  \"blocks\": %d,\n", s->blocks);
+    fprintf(fp, "  \"lines\": %d,\n", s->lines);
+    fprintf(fp, "  \"pieces_per_second\": %.3f,\n", seconds > 0 ? s->blocks / seconds : 0);
+    fprintf(fp, "  \"keys_per_piece\": %.3f,\n", s->blocks > 0 ? (double)st->keys / s->blocks : 0);
+    fprintf(fp, "  \"peak_height\": %d,\n", st->peak_height);
+    fprintf(fp, "  \"pieces\": {");
+    for (i = BLOCK_L; i <= BLOCK_T; i ++)
+    {
+        fprintf(fp, "%s\"%s\": %u", (i > BLOCK_L) ? ", " : "", stats_piece_names[i], st->pieces[i]);
+    }
+
+    fprintf(fp, "},\n");
+    fprintf(fp, "  \"clears\": [%u, %u, %u, %u],\n", st->clears[1], st->clears[2], st->clears[3], st->clears[4]);
+    fprintf(fp, "  \"level_seconds\": {");
+    int first = 1;
+    for (i = MIN_TETRIS_LEVEL; i <= MAX_TETRIS_LEVEL; i ++)
+    {
+        if (st->level_ticks[i] > 0)
+        {
+            fprintf(fp, "%s\"%d\": %.2f", first ? "" : ", ", i, st->level_ticks[i] * STATS_TICK_SECONDS);
+            first = 0;
+        }
+    }
+
+    fprintf(fp, "}\n}\n");
+
+    return;
+}
+
+static void _stats_csv(FILE *fp, struct tetris_scene_t *s, double seconds)
+{
+    const struct tetris_stats_t *st = &s->stats;
+    int i;
+
+    // Header only for a fresh file, sessions accumulate as rows
+    fseek(fp, 0, SEEK_END);
+    if (ftell(fp) == 0)
+    {
+        fprintf(fp, "seconds,score,blocks,lines,pieces_per_second,keys_per_piece,peak_height");
+        for (i = BLOCK_L; i <= BLOCK_T; i ++)
+        {
+            fprintf(fp, ",piece_%s", stats_piece_names[i]);
+        }
+
+        fprintf(fp, ",single,double,triple,tetris");
+        for (i = MIN_TETRIS_LEVEL; i <= MAX_TETRIS_LEVEL; i ++)
+        {
+            fprintf(fp, ",level_%d_seconds", i);
+        }
+
+        fprintf(fp, "\n");
+    }
+
+    fprintf(fp, "%.2f,%d,%d,%d,%.3f,%.3f,%d",
+        seconds,
+        s->score,
+        s->blocks,
+        s->lines,
+        seconds > 0 ? s->blocks / seconds : 0,
+        s->blocks > 0 ? (double)st->keys / s->blocks : 0,
+        st->peak_height);
+    for (i = BLOCK_L; i <= BLOCK_T; i ++)
+    {
+        fprintf(fp, ",%u", st->pieces[i]);
+    }
+
+    fprintf(fp, ",%u,%u,%u,%u", st->clears[1], st->clears[2], st->clears[3], st->clears[4]);
+    for (i = MIN_TETRIS_LEVEL; i <= MAX_TETRIS_LEVEL; i ++)
+    {
+        fprintf(fp, ",%.2f", st->level_ticks[i] * STATS_TICK_SECONDS);
+    }
+
+    fprintf(fp, "\n");
+
+    return;
+}
+
+int stats_write(struct tetris_scene_t *s, const char *path)
+{
+    size_t len = strlen(path);
+    bool csv = len > 4 && 0 == strcasecmp(path + len - 4, ".csv");
+    unsigned long long int ticks = 0;
+    int i;
+
+    FILE *fp = fopen(path, csv ? "a" : "w");
+    if (fp == NULL)
+    {
+        return -1;
+    }
+
+    for (i = MIN_TETRIS_LEVEL; i <= MAX_TETRIS_LEVEL; i ++)
+    {
+        ticks += s->stats.level_ticks[i];
+    }
+
+    if (csv)
+    {
+        _stats_csv(fp, s, ticks * STATS_TICK_SECONDS);
+    }
+    else
+    {
+        _stats_json(fp, s, ticks * STATS_TICK_SECONDS);
+    }
+
+    return fclose(fp);
+}
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
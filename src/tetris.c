@@ -27,10 +27,24 @@
  * @since 10/17/2021
  */
 
+#include <pthread.h>
 #include "tetris.h"
 
+// Scene owned by simulation thread once play starts, renderer draws from view
 struct tetris_scene_t scene;
-timer_t timer;
+struct tetris_scene_t *view = &scene;
+struct input_ring_t input;
+struct snapshot_buffer_t snapshots;
+bool sim_quit = FALSE;
+
+// In process bot placing every block at spawn, NULL for human play
+struct bot_plugin_t *bot_plugin = NULL;
+
+// Recording of the running game, written by simulation thread
+struct replay_writer_t *recorder = NULL;
+
+// Piece shown by replay viewer, -1 while playing
+int replay_piece = -1;
 
 WINDOW *playground_box = NULL;
 WINDOW *score_box = NULL;
@@ -39,8 +53,17 @@ WINDOW *blocks_box = NULL;
 WINDOW *next_box = NULL;
 WINDOW *trace_box = NULL;
 
-BLOCK *curr_block = NULL;
-BLOCK *next_block = NULL;
+// Performance overlay in trace box
+bool perf_hud = FALSE;
+
+// Cell glyph pairs with color and attribute baked in, indexed by color pair for blocks
+chtype glyph_empty[2];
+chtype glyph_solid[2];
+chtype glyph_block[40][2];
+
+// Windows staged into the virtual screen since the last flush
+bool frame_dirty = FALSE;
+uint64_t frame_begin = 0;
 
 int check_window()
 {
@@ -122,6 +145,23 @@ void color_pairs()
     return;
 }
 
+// Build cell glyphs once, ACS characters are only known after initscr
+void glyph_cache()
+{
+    int c;
+    glyph_empty[0] = ' ' | A_DIM | COLOR_PAIR(7);
+    glyph_empty[1] = ACS_DIAMOND | A_DIM | COLOR_PAIR(7);
+    glyph_solid[0] = ' ' | A_DIM | COLOR_PAIR(8);
+    glyph_solid[1] = ACS_DIAMOND | A_DIM | COLOR_PAIR(8);
+    for (c = 24; c < 32; c ++)
+    {
+        glyph_block[c][0] = ACS_CKBOARD | A_BOLD | COLOR_PAIR(c);
+        glyph_block[c][1] = ACS_CKBOARD | A_BOLD | COLOR_PAIR(c);
+    }
+
+    return;
+}
+
 // Draw tile maps with CKBOARD
 void _splash_title_char(WINDOW *win, char **c, int lines,  int y, int x, int color_idx)
 {
@@ -150,575 +190,428 @@ void _splash_title_char(WINDOW *win, char **c, int lines,  int y, int x, int col
     return;
 }
 
-// Boxes
-void _render_boxes()
+// Stage window into virtual screen, flushed by _render_flush
+void _render_stage(WINDOW *win)
 {
-    if (score_box == NULL || level_box == NULL || blocks_box == NULL)
+    if (!frame_dirty)
     {
-        return;
+        frame_begin = perf_now();
+        frame_dirty = TRUE;
+        PROBE(render_begin);
     }
 
-    static char buf[32];
-    memset(buf, 0, 32);
-    sprintf(buf, "%07d", scene.score);
-    wattron(score_box, A_BOLD);
-    wattron(score_box, COLOR_PAIR(2));
-    mvwaddstr(score_box, 4, 6, buf);
-    wattroff(score_box, COLOR_PAIR(2));
-    wattroff(score_box, A_BOLD);
-
-    memset(buf, 0, 32);
-    sprintf(buf, "%7d", scene.level);
-    wattron(level_box, A_BOLD);
-    wattron(level_box, COLOR_PAIR(6));
-    mvwaddstr(level_box, 4, 6, buf);
-    wattroff(level_box, COLOR_PAIR(6));
-    wattroff(level_box, A_BOLD);
-
-    memset(buf, 0, 32);
-    sprintf(buf, "%07d", scene.blocks);
-    wattron(blocks_box, A_BOLD);
-    wattron(blocks_box, COLOR_PAIR(5));
-    mvwaddstr(blocks_box, 4, 6, buf);
-    wattroff(blocks_box, COLOR_PAIR(5));
-    wattroff(blocks_box, A_BOLD);
-
-    wrefresh(score_box);
-    wrefresh(level_box);
-    wrefresh(blocks_box);
+    wnoutrefresh(win);
 
     return;
 }
 
-// Next block window
-void _render_next()
+// Flush staged windows to terminal, at most once per frame
+void _render_flush()
 {
-    if (next_block == NULL)
+    if (!frame_dirty)
     {
         return;
     }
 
-    int i, j, sign;
-    wattron(next_box, A_BOLD);
-    for (i = 0; i < 4; i ++)
-    {
-        for (j = 0; j < 4; j ++)
-        {
-            sign = (1 << (i * 4 + j)) & next_block->tile;
-            if (sign > 0)
-            {
-                wattron(next_box, COLOR_PAIR(next_block->color));
-            }
-            else
-            {
-                wattron(next_box, COLOR_PAIR(24));
-            }
-
-            mvwaddch(next_box, 6 - i, 10 - j * 2, ACS_CKBOARD);
-            mvwaddch(next_box, 6 - i, 11 - j * 2, ACS_CKBOARD);
-        }
-    }
-
-    wattroff(next_box, A_BOLD);
-    wrefresh(next_box);
+    uint64_t t = trace_clock();
+    doupdate();
+    trace_span("doupdate", t);
+    frame_dirty = FALSE;
+    uint64_t ns = perf_now() - frame_begin;
+    perf_frame(ns);
+    PROBE1(render_end, ns);
+    EVLOG(EVLOG_FRAME, 0, ns);
 
     return;
 }
 
-// Playground refresh
-void _render_playground()
+// Status panel observing one scene value, redrawn when it changes
+struct status_panel_t
+{
+    WINDOW            **win;
+    size_t              offset;
+    const char         *format;
+    int                 color;
+    int                 drawn;
+    bool                valid;
+};
+
+struct status_panel_t status_panels[] = {
+    {&score_box, offsetof(struct tetris_scene_t, score), "%07d", 2, 0, FALSE},
+    {&level_box, offsetof(struct tetris_scene_t, level), "%7d", 6, 0, FALSE},
+    {&blocks_box, offsetof(struct tetris_scene_t, blocks), "%07d", 5, 0, FALSE},
+};
+
+void _render_next();
+
+// Boxes, only panels whose value moved since last frame
+void _render_boxes()
 {
-    char dot;
-    int i, j, sign;
-    int pos_x, pos_y;
+    static bool synced = FALSE;
+    static unsigned int seen_version;
+    static unsigned int next_head, next_tail;
+    int i;
 
-    for (i = 0; i < PLAYGROUND_HEIGHT; i ++)
+    if (score_box == NULL || level_box == NULL || blocks_box == NULL)
     {
-        for (j = 0; j < PLAYGROUND_WIDTH; j ++)
-        {
-            // Redraw
-            if (scene.playground[i][j] == 'c')
-            {
-                scene.playground[i][j] = 0;
-            }
+        return;
+    }
 
-            if (check_block_solid(curr_block,0, 0, 0, i, j))
-            {
-                scene.playground[i][j] = 'c';
-            }
-        }
+    // Nothing observable changed, skip without formatting
+    if (synced && seen_version == view->version)
+    {
+        return;
     }
 
-    for (i = 0; i < PLAYGROUND_HEIGHT; i ++)
+    uint64_t t = trace_clock();
+    static char buf[32];
+    for (i = 0; i < sizeof(status_panels) / sizeof(struct status_panel_t); i ++)
     {
-        for (j = 0; j < PLAYGROUND_WIDTH; j ++)
+        struct status_panel_t *p = &status_panels[i];
+        int value = *(const int *)((const char *)view + p->offset);
+        if (p->valid && p->drawn == value)
         {
-            dot = scene.playground[i][j];
-            if ('c' == dot && curr_block != NULL)
-            {
-                wattron(playground_box, A_BOLD);
-                wattron(playground_box, COLOR_PAIR(curr_block->color));
-                mvwaddch(playground_box, PLAYGROUND_HEIGHT - i, j * 2 + 1, ACS_CKBOARD);
-                mvwaddch(playground_box, PLAYGROUND_HEIGHT - i, j * 2 + 2, ACS_CKBOARD);
-                wattroff(playground_box, COLOR_PAIR(curr_block->color));
-                wattroff(playground_box, A_BOLD);
-            }
-            else if('b' == dot)
-            {
-                wattron(playground_box, A_DIM);
-                wattron(playground_box, COLOR_PAIR(8));
-                mvwaddch(playground_box, PLAYGROUND_HEIGHT - i, j * 2 + 1, ' ');
-                mvwaddch(playground_box, PLAYGROUND_HEIGHT - i, j * 2 + 2, ACS_DIAMOND);
-                wattroff(playground_box,COLOR_PAIR(8));
-                wattroff(playground_box, A_DIM);
-            }
-            else if ('e' == dot)
-            {
-                wattron(playground_box, A_DIM);
-                wattron(playground_box, COLOR_PAIR(16));
-                mvwaddch(playground_box, PLAYGROUND_HEIGHT - i, j * 2 + 1, ' ');
-                mvwaddch(playground_box, PLAYGROUND_HEIGHT - i, j * 2 + 2, ACS_DIAMOND);
-                wattroff(playground_box,COLOR_PAIR(16));
-                wattroff(playground_box, A_DIM);
-            }
-            else if (0 == dot)
-            {
-                wattron(playground_box, A_DIM);
-                wattron(playground_box, COLOR_PAIR(7));
-                mvwaddch(playground_box, PLAYGROUND_HEIGHT - i, j * 2 + 1, ' ');
-                mvwaddch(playground_box, PLAYGROUND_HEIGHT - i, j * 2 + 2, ACS_DIAMOND);
-                wattroff(playground_box, COLOR_PAIR(7));
-                wattroff(playground_box, A_DIM);
-            }
+            continue;
         }
-    }
 
-    // Some trace info
-    static char curr_trace_str[16];
-    memset(curr_trace_str, 0, 16);
+        memset(buf, 0, 32);
+        sprintf(buf, p->format, value);
+        wattron(*p->win, A_BOLD);
+        wattron(*p->win, COLOR_PAIR(p->color));
+        mvwaddstr(*p->win, 4, 6, buf);
+        wattroff(*p->win, COLOR_PAIR(p->color));
+        wattroff(*p->win, A_BOLD);
+        _render_stage(*p->win);
+        p->drawn = value;
+        p->valid = TRUE;
+    }
 
-    wattron(trace_box, COLOR_PAIR(2));
-    wattron(trace_box, A_BOLD);
-    if (curr_block != NULL)
+    if (!synced || next_head != view->queue.head || next_tail != view->queue.tail)
     {
-        sprintf(curr_trace_str, "%d-><%2d : %2d>", curr_block->type, curr_block->pos.y, curr_block->pos.x);
+        _render_next();
+        next_head = view->queue.head;
+        next_tail = view->queue.tail;
     }
 
-    mvwaddstr(trace_box, 4, 2, curr_trace_str);
-    sprintf(curr_trace_str, "Status : %d", scene.status);
-    mvwaddstr(trace_box, 5, 2, curr_trace_str);
-    wattroff(trace_box, A_BOLD);
-    wattroff(trace_box, COLOR_PAIR(2));
-
-    wrefresh(playground_box);
-    wrefresh(trace_box);
+    seen_version = view->version;
+    synced = TRUE;
+    trace_span("render_boxes", t);
 
     return;
 }
 
-/* {{{ [Block activities] */
-bool _curr_block_rotate(bool clockwise, enum block_direction_e *dir, int *tile)
+// Next blocks window, one 4 rows slot per preview
+void _render_next()
 {
-    if (curr_block == NULL)
-    {
-        return FALSE;
-    }
-
-    enum block_direction_e m_dir;
-    int i, j;
-    int m_tile = try_rotate_block(curr_block, clockwise, &m_dir);
-    for (i = 0; i < PLAYGROUND_HEIGHT; i ++)
+    chtype line[8];
+    int i, j, k, tile, color = 24, type;
+    uint64_t t = trace_clock();
+    for (k = 0; k < view->config.preview; k ++)
     {
-        if (check_block_solid(curr_block, m_tile, 0, 0, i, -1))
+        type = queue_peek(&view->queue, k, &color);
+        tile = (type != BLOCK_UNKNOWN) ? tile_block(type, BLOCK_DIR_0) : 0;
+        for (i = 0; i < 4; i ++)
         {
-            return FALSE;
-        }
-
-        if (check_block_solid(curr_block, m_tile, 0, 0, i, PLAYGROUND_WIDTH))
-        {
-            return FALSE;
-        }
-
-        for (j = 0; j < PLAYGROUND_WIDTH; j ++)
-        {
-            if ('b' == scene.playground[i][j] && check_block_solid(curr_block, m_tile, 0, 0, i, j))
+            // Tile keeps column 0 in the high bit of each nibble
+            for (j = 0; j < 4; j ++)
             {
-                return FALSE;
+                const chtype *g = ((1 << (i * 4 + 3 - j)) & tile) ? glyph_block[color] : glyph_block[24];
+                line[j * 2] = g[0];
+                line[j * 2 + 1] = g[1];
             }
+
+            mvwaddchnstr(next_box, 6 + k * 4 - i, 4, line, 8);
         }
     }
 
-    *dir = m_dir;
-    *tile = m_tile;
+    _render_stage(next_box);
+    trace_span("render_next", t);
 
-    return TRUE;
+    return;
 }
 
-bool _curr_block_left()
+// Trace box, block position / status or performance overlay
+void _render_trace(BLOCK *curr_block)
 {
-    if (curr_block == NULL)
-    {
-        return FALSE;
-    }
+    static bool hud_drawn = FALSE;
+    static char curr_trace_str[32];
+    uint64_t t = trace_clock();
+    int i;
 
-    // Check edge
-    int i, j;
-    for (i = 0; i < PLAYGROUND_HEIGHT; i ++)
+    // Switch title and wipe the other mode's lines
+    if (hud_drawn != perf_hud)
     {
-        if (check_block_solid(curr_block, 0, 0, -1, i, -1))
+        for (i = 1; i < TRACE_BOX_HEIGHT - 1; i ++)
         {
-            return FALSE;
+            mvwaddstr(trace_box, i, 1, "              ");
         }
 
-        for (j = 0; j < PLAYGROUND_WIDTH; j ++)
-        {
-            if ('b' == scene.playground[i][j] && check_block_solid(curr_block,0, 0, -1, i, j))
-            {
-                return FALSE;
-            }
-        }
-    }
-
-    return TRUE; 
-}
-
-bool _curr_block_right()
-{
-    if (curr_block == NULL)
-    {
-        return FALSE;
+        wattron(trace_box, A_BOLD);
+        wattron(trace_box, COLOR_PAIR(3));
+        mvwaddstr(trace_box, 1, 3, perf_hud ? "PERF" : "TRACE");
+        wattroff(trace_box, COLOR_PAIR(3));
+        wattroff(trace_box, A_BOLD);
+        hud_drawn = perf_hud;
     }
 
-    // Check edge
-    int i, j;
-    for (i = 0; i < PLAYGROUND_HEIGHT; i ++)
+    memset(curr_trace_str, 0, sizeof(curr_trace_str));
+    wattron(trace_box, COLOR_PAIR(2));
+    wattron(trace_box, A_BOLD);
+    if (perf_hud)
     {
-        if (check_block_solid(curr_block,0, 0, 1, i, PLAYGROUND_WIDTH))
+        const struct perf_report_t *r = perf_report();
+        snprintf(curr_trace_str, sizeof(curr_trace_str), "FPS  %8u", r->fps);
+        mvwaddstr(trace_box, 2, 2, curr_trace_str);
+        snprintf(curr_trace_str, sizeof(curr_trace_str), "TICK %6.0fus", r->tick_mean_us);
+        mvwaddstr(trace_box, 3, 2, curr_trace_str);
+        snprintf(curr_trace_str, sizeof(curr_trace_str), "P99  %6.0fus", r->tick_p99_us);
+        mvwaddstr(trace_box, 4, 2, curr_trace_str);
+        snprintf(curr_trace_str, sizeof(curr_trace_str), "DRAW %6.0fus", r->render_us);
+        mvwaddstr(trace_box, 5, 2, curr_trace_str);
+        if (r->io)
         {
-            return FALSE;
+            snprintf(curr_trace_str, sizeof(curr_trace_str), "WR/S %8llu", r->written_ps);
+            mvwaddstr(trace_box, 6, 2, curr_trace_str);
+            snprintf(curr_trace_str, sizeof(curr_trace_str), "IO/S %8llu", r->io_calls_ps);
+            mvwaddstr(trace_box, 7, 2, curr_trace_str);
         }
-
-        for (j = 0; j < PLAYGROUND_WIDTH; j ++)
+        else
         {
-            if ('b' == scene.playground[i][j] && check_block_solid(curr_block, 0, 0, 1, i, j))
-            {
-                return FALSE;
-            }
+            mvwaddstr(trace_box, 6, 2, "WR/S        -");
+            mvwaddstr(trace_box, 7, 2, "IO/S        -");
         }
     }
-
-    return TRUE; 
-}
-
-bool _curr_block_down()
-{
-    if (curr_block == NULL)
-    {
-        return FALSE;
-    }
-
-    // Check edge
-    int i, j;
-    for (j = 0; j < PLAYGROUND_WIDTH; j ++)
+    else
     {
-        if (check_block_solid(curr_block, 0, -1, 0, -1, j))
+        if (curr_block != NULL)
         {
-            return FALSE;
+            sprintf(curr_trace_str, "%d-><%2d : %2d>", curr_block->type, curr_block->pos.y, curr_block->pos.x);
         }
 
-        for (i = 0; i < PLAYGROUND_HEIGHT; i ++)
+        mvwaddstr(trace_box, 4, 2, curr_trace_str);
+        sprintf(curr_trace_str, "Status : %d", view->status);
+        mvwaddstr(trace_box, 5, 2, curr_trace_str);
+        if (replay_piece >= 0)
         {
-            if ('b' == scene.playground[i][j] && check_block_solid(curr_block, 0, -1, 0, i, j))
-            {
-                return FALSE;
-            }
+            snprintf(curr_trace_str, sizeof(curr_trace_str), "Piece %6d", replay_piece);
+            mvwaddstr(trace_box, 6, 2, curr_trace_str);
         }
     }
 
-    return TRUE; 
-}
+    wattroff(trace_box, A_BOLD);
+    wattroff(trace_box, COLOR_PAIR(2));
+    trace_span("render_trace", t);
 
-void _curr_block_drop()
-{
-    // We do nothing now
     return;
 }
 
-void _curr_block_solidify()
+// Playground refresh
+void _render_playground()
 {
-    if (curr_block == NULL)
-    {
-        return;
-    }
-
+    BLOCK *curr_block = game_curr(view);
+    chtype line[PLAYGROUND_WIDTH * 2];
+    uint16_t piece, solid;
+    uint64_t t = trace_clock();
     int i, j;
-    int dx, dy;
-    for (i = 0; i < 4; i ++)
+
+    // One span per row
+    for (i = 0; i < PLAYGROUND_HEIGHT; i ++)
     {
-        for (j = 0; j < 4; j ++)
+        piece = 0;
+        if (curr_block != NULL && i >= curr_block->pos.y && i < curr_block->pos.y + 4)
         {
-            dy = curr_block->pos.y + i;
-            dx = curr_block->pos.x + j;
-            if (dx >=0 && dx < PLAYGROUND_WIDTH && dy >= 0 && dy < PLAYGROUND_HEIGHT)
-            {
-                if ((1 << (i * 4 + (3 - j)) & curr_block->tile) > 0)
-                {
-                    scene.playground[dy][dx] = 'b';
-                }
-            }
+            piece = block_rows[curr_block->type][curr_block->direction][i - curr_block->pos.y];
+            piece = (curr_block->pos.x >= 0) ? piece << curr_block->pos.x : piece >> -curr_block->pos.x;
         }
-    }
 
-    return;
-}
-
-/* }}} */
-
-/* {{{ [Main loops for game] */
-
-// Calculate score, clear full row
-void _check_score()
-{
-    static char tmp[PLAYGROUND_HEIGHT][PLAYGROUND_WIDTH];
-    int i, j, ct, copied = 0, e = 0;
-    memset(tmp, 0, sizeof(tmp));
-    for (i = 0; i < PLAYGROUND_HEIGHT; i ++)
-    {
-        ct = 0;
+        solid = view->board.rows[i];
         for (j = 0; j < PLAYGROUND_WIDTH; j ++)
         {
-            tmp[copied][j] = scene.playground[i][j];
-            if (scene.playground[i][j] == 'b')
+            const chtype *g = glyph_empty;
+            if ((piece >> j) & 1)
             {
-                ct ++;
+                g = glyph_block[curr_block->color];
+            }
+            else if ((solid >> j) & 1)
+            {
+                g = glyph_solid;
             }
-        }
 
-        if (ct < PLAYGROUND_WIDTH)
-        {
-            copied ++;
+            line[j * 2] = g[0];
+            line[j * 2 + 1] = g[1];
         }
-        else
-        {
-            e ++;
-        }
-    }
 
-    // 1 -> 3 / 2 -> 8 / 3 -> 20 / 4 -> 50
-    memcpy(scene.playground, tmp, sizeof(tmp));
-    switch (e)
-    {
-        case 4:
-            scene.score += 50;
-            break;
-        case 3:
-            scene.score += 20;
-            break;
-        case 2:
-            scene.score += 8;
-            break;
-        case 0:
-            break;
-        default:
-            scene.score += 3;
-            break;
+        mvwaddchnstr(playground_box, PLAYGROUND_HEIGHT - i, 1, line, PLAYGROUND_WIDTH * 2);
     }
 
+    _render_trace(curr_block);
+
+    _render_stage(playground_box);
+    _render_stage(trace_box);
+    trace_span("render_playground", t);
+
     return;
 }
 
-// On timer event
-void _on_timer()
-{
-    static unsigned long long int timer_counter = 0;
-
-    // Asset blocks
-    if (next_block == NULL)
-    {
-        next_block = new_block();
-        _render_next();
-    }
+/* {{{ [Main loops for game] */
 
-    if (curr_block == NULL)
+// Simulation thread, fixed rate gravity and input, publishes a snapshot on change
+void * _sim_thread(void *arg)
+{
+    struct timespec next;
+    struct placement_t placed;
+    enum game_key_e key;
+    unsigned int version;
+    uint32_t tick;
+    bool moved;
+    int ev;
+
+    trace_thread("sim");
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (!__atomic_load_n(&sim_quit, __ATOMIC_ACQUIRE))
     {
-        curr_block = next_block;
-        next_block = new_block();
-        _render_next();
-        curr_block->pos.x = (PLAYGROUND_WIDTH - 4) / 2;
-        curr_block->pos.y = PLAYGROUND_HEIGHT - 4;
-        scene.blocks ++;
-        scene.score ++;
-        if (STATUS_PREPARE == scene.status)
+        // Absolute deadlines, a late tick does not shift the ones after it
+        next.tv_nsec += SIM_PERIOD_NS;
+        if (next.tv_nsec >= 1000000000)
         {
-            scene.status = STATUS_PLAYING;
+            next.tv_sec ++;
+            next.tv_nsec -= 1000000000;
         }
 
-        _render_playground();
-    }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
 
-    if (curr_block->dropped)
-    {
-        timer_counter = scene.speed - 1;
-    }
-
-    if (timer_counter % scene.speed == scene.speed - 1)
-    {
-        if (curr_block != NULL)
+        uint64_t begin = perf_now();
+        uint64_t t = trace_clock();
+        version = scene.version;
+        tick = scene.timer_counter;
+        moved = FALSE;
+        while (GAME_KEY_NONE != (key = input_pop(&input)))
         {
-            // Move down automatically
-            if (_curr_block_down())
+            if (recorder != NULL)
             {
-                curr_block->pos.y --;
+                replay_key(recorder, tick, key);
             }
-            else
-            {
-                _curr_block_solidify();
 
-                // Failure?
-                if (PLAYGROUND_HEIGHT - 4 <= curr_block->pos.y)
-                {
-                    _render_playground();
-                    scene.status = STATUS_OVER;
-                    timer_delete(timer);
+            moved |= game_input(&scene, key);
+        }
 
-                    return;
-                }
+        uint64_t t_tick = trace_clock();
+        ev = game_tick(&scene);
+        trace_span("game_tick", t_tick);
+        if ((ev & EVENT_SPAWN) && bot_plugin != NULL)
+        {
+            uint64_t t_bot = trace_clock();
+            int placed_ev = bot_plugin_place(bot_plugin, &scene, &placed);
+            trace_span("bot", t_bot);
+            if (placed_ev && recorder != NULL)
+            {
+                replay_place(recorder, tick, &placed);
+            }
 
-                del_block(curr_block);
-                curr_block = NULL;
+            ev |= placed_ev;
+        }
 
-                // Check score
-                _check_score();
-                if (scene.score >= EGG_SCORE)
-                {
-                    _render_playground();
-                    scene.status = STATUS_EGG;
-                    timer_delete(timer);
+        if (recorder != NULL)
+        {
+            replay_tick(recorder, &scene, ev);
+        }
 
-                    return;
-                }
-            }
+        if (moved || ev || version != scene.version)
+        {
+            snapshot_publish(&snapshots, &scene);
+            shm_export_publish(&scene);
         }
 
-        _render_playground();
+        uint64_t ns = perf_now() - begin;
+        perf_tick(ns);
+        trace_span("tick", t);
+        EVLOG(EVLOG_TICK, ev, ns);
+        if (ev & EVENT_END)
+        {
+            break;
+        }
     }
 
-    _render_boxes();
-    timer_counter ++;
-
-    return;
+    return NULL;
 }
 
-// Main loop of game
+// Main loop of game, this thread reads keys and renders latest snapshot
 void tetris_loop()
 {
-    struct sigevent evp;
-    struct timespec spec;
-    struct itimerspec tv;
+    struct tetris_scene_t *latest;
+    pthread_t sim;
+    bool redraw;
     int ch;
 
-    evp.sigev_value.sival_ptr = &timer;
-    evp.sigev_notify = SIGEV_SIGNAL;
-    evp.sigev_signo = SIGUSR1;
-    signal(SIGUSR1, _on_timer);
-    int ret = timer_create(CLOCK_MONOTONIC, &evp, &timer);
-    if (ret)
+    snapshot_init(&snapshots, &scene);
+    sim_quit = FALSE;
+    if (0 != pthread_create(&sim, NULL, _sim_thread, NULL))
     {
-        perror("timer_create");
-    }
+        perror("pthread_create");
 
-    clock_gettime(CLOCK_MONOTONIC, &spec);
-    tv.it_interval.tv_sec = 0;
-    tv.it_interval.tv_nsec = 10000000;
-    tv.it_value.tv_sec = spec.tv_sec + 0;
-    tv.it_value.tv_nsec = spec.tv_nsec + 1000000;
-    ret = timer_settime(timer, CLOCK_MONOTONIC, &tv, NULL);
-    if (ret)
-    {
-        perror("timer_settime");
+        return;
     }
 
-    while (ch = getch())
+    // Wake up for keys or to pick up a new snapshot, whichever comes first
+    timeout(RENDER_POLL_MS);
+    while (TRUE)
     {
+        ch = getch();
+
         // KEY_ESC
         if ('\033' == ch)
-        {
-            timer_delete(timer);
-            break;
-        }
-
-        // Break out loop
-        if (STATUS_OVER == scene.status || STATUS_EGG == scene.status)
         {
             break;
         }
 
-        enum block_direction_e dir = BLOCK_DIR_0;
-        int tile = 0;
+        enum game_key_e key = GAME_KEY_NONE;
+        redraw = FALSE;
         switch (ch)
         {
             case KEY_LEFT:
             case 'a':
             case 'A':
                 // Block left
-                if (_curr_block_left())
-                {
-                    curr_block->pos.x --;
-                }
+                key = GAME_KEY_LEFT;
 
                 break;
             case KEY_RIGHT:
             case 'd':
             case 'D':
                 // Block right
-                if (_curr_block_right())
-                {
-                    curr_block->pos.x ++;
-                }
+                key = GAME_KEY_RIGHT;
 
                 break;
             case KEY_DOWN:
             case 's':
             case 'S':
                 // Block down
-                if (_curr_block_down())
-                {
-                    curr_block->pos.y --;
-                }
+                key = GAME_KEY_DOWN;
 
                 break;
             case '\n':
             case ' ':
                 // Block drop
-                while (_curr_block_down())
-                {
-                    curr_block->pos.y --;
-                }
-
-                if (curr_block != NULL)
-                {
-                    curr_block->dropped = true;
-                }
+                key = GAME_KEY_DROP;
 
                 break;
             case 'j':
             case 'J':
                 // Rotate -90
-                if (_curr_block_rotate(FALSE, &dir, &tile))
-                {
-                    curr_block->direction = dir;
-                    curr_block->tile = tile;
-                }
+                key = GAME_KEY_ROTATE_CCW;
 
                 break;
             case 'k':
             case 'K':
                 // Rotate + 90
-                if (_curr_block_rotate(TRUE, &dir, &tile))
-                {
-                    curr_block->direction = dir;
-                    curr_block->tile = tile;
-                }
+                key = GAME_KEY_ROTATE_CW;
+
+                break;
+            case 'p':
+            case 'P':
+                // Performance overlay
+                perf_hud = !perf_hud;
+                redraw = TRUE;
 
                 break;
             default:
@@ -726,7 +619,135 @@ void tetris_loop()
                 break;
         }
 
+        if (GAME_KEY_NONE != key)
+        {
+            input_push(&input, key);
+        }
+
+        if (NULL != (latest = snapshot_acquire(&snapshots)))
+        {
+            view = latest;
+            redraw = TRUE;
+        }
+
+        if (redraw)
+        {
+            _render_boxes();
+            _render_playground();
+            _render_flush();
+        }
+
+        // Break out loop
+        if (STATUS_OVER == view->status || STATUS_EGG == view->status)
+        {
+            break;
+        }
+    }
+
+    __atomic_store_n(&sim_quit, TRUE, __ATOMIC_RELEASE);
+    pthread_join(sim, NULL);
+    timeout(-1);
+    view = &scene;
+
+    return;
+}
+
+// Replay viewer, every move re-seeks from the nearest keyframe
+void tetris_replay_loop(const struct replay_t *r)
+{
+    int total = replay_blocks(r);
+    int interval = replay_keyframe_interval(r);
+    int piece = (total > 0) ? 1 : 0;
+    int win_width, win_height, ch;
+    bool playing = FALSE;
+
+    while (TRUE)
+    {
+        win_width = scene.win_width;
+        win_height = scene.win_height;
+        replay_piece = replay_seek(r, piece, &scene);
+        scene.win_width = win_width;
+        scene.win_height = win_height;
+        view = &scene;
+        _render_boxes();
         _render_playground();
+        _render_flush();
+
+        timeout(playing ? REPLAY_PLAY_MS : -1);
+        ch = getch();
+        switch (ch)
+        {
+            case ERR:
+                // Playing, next piece
+                piece ++;
+
+                break;
+            case KEY_RIGHT:
+            case 'd':
+            case 'D':
+                piece ++;
+
+                break;
+            case KEY_LEFT:
+            case 'a':
+            case 'A':
+                piece --;
+
+                break;
+            case KEY_UP:
+                piece += 10;
+
+                break;
+            case KEY_DOWN:
+                piece -= 10;
+
+                break;
+            case KEY_NPAGE:
+                piece += interval;
+
+                break;
+            case KEY_PPAGE:
+                piece -= interval;
+
+                break;
+            case KEY_HOME:
+                piece = 1;
+
+                break;
+            case KEY_END:
+                piece = total;
+
+                break;
+            case ' ':
+                playing = !playing;
+
+                break;
+            case 'p':
+            case 'P':
+                perf_hud = !perf_hud;
+
+                break;
+            case 'q':
+            case 'Q':
+            case '\033':
+                timeout(-1);
+                replay_piece = -1;
+
+                return;
+            default:
+                break;
+        }
+
+        if (piece > total)
+        {
+            piece = total;
+            playing = FALSE;
+        }
+
+        if (piece < 1)
+        {
+            piece = (total > 0) ? 1 : 0;
+        }
     }
 
     return;
@@ -784,6 +805,7 @@ void tetris_splash()
     mvwaddstr(topic_box, 4, 4, "<KEY-DOWN> / 's' for move down");
     mvwaddstr(topic_box, 5, 4, "j / k for rotation");
     mvwaddstr(topic_box, 6, 4, "<SPACE> / <ENTER> for drop");
+    mvwaddstr(topic_box, 7, 4, "p for performance overlay");
     mvwaddstr(topic_box, 8, 9, "Any key to continue ...");
     wattroff(topic_box, COLOR_PAIR(7));
 
@@ -794,8 +816,9 @@ void tetris_splash()
     wclear(splash_box);
     wclear(topic_box);
     wbkgd(splash_box, COLOR_PAIR(1));
-    wrefresh(splash_box);
-    wrefresh(topic_box);
+    wnoutrefresh(splash_box);
+    wnoutrefresh(topic_box);
+    doupdate();
     delwin(splash_box);
     delwin(topic_box);
 
@@ -866,7 +889,7 @@ void tetris_interface()
 
     // Next
     next_box = newwin(
-        NEXT_BOX_HEIGHT,
+        NEXT_BOX_HEIGHT(scene.config.preview),
         NEXT_BOX_WIDTH,
         5,
         (scene.win_width + PLAYGROUND_WIDTH * 2) / 2 + 3);
@@ -880,12 +903,20 @@ void tetris_interface()
     wattroff(next_box, COLOR_PAIR(3));
     wattroff(next_box, A_BOLD);
 
-    // Trace
+    // Trace, below next blocks if they leave room, under blocks box otherwise
+    int trace_y = 6 + NEXT_BOX_HEIGHT(scene.config.preview);
+    int trace_x = (scene.win_width + PLAYGROUND_WIDTH * 2) / 2 + 3;
+    if (trace_y + TRACE_BOX_HEIGHT >= scene.win_height)
+    {
+        trace_y = 7 + MSG_BOX_HEIGHT * 3;
+        trace_x = (scene.win_width - PLAYGROUND_WIDTH * 2) / 2 - 3 - MSG_BOX_WIDTH;
+    }
+
     trace_box = newwin(
         TRACE_BOX_HEIGHT,
         TRACE_BOX_WIDTH,
-        6 + NEXT_BOX_HEIGHT,
-        (scene.win_width + PLAYGROUND_WIDTH * 2) / 2 + 3);
+        trace_y,
+        trace_x);
     wbkgd(trace_box, COLOR_PAIR(7));
     wattron(trace_box, COLOR_PAIR(4));
     box(trace_box, 0, 0);
@@ -896,12 +927,13 @@ void tetris_interface()
     wattroff(trace_box, COLOR_PAIR(3));
     wattroff(trace_box, A_BOLD);
     
-    wrefresh(playground_box);
-    wrefresh(score_box);
-    wrefresh(level_box);
-    wrefresh(blocks_box);
-    wrefresh(next_box);
-    wrefresh(trace_box);
+    _render_stage(playground_box);
+    _render_stage(score_box);
+    _render_stage(level_box);
+    _render_stage(blocks_box);
+    _render_stage(next_box);
+    _render_stage(trace_box);
+    _render_flush();
 
     return;
 }
@@ -1007,6 +1039,117 @@ void tetris_quit()
 
 /* }}} */
 
+/* {{{ [Headless] */
+
+// Count placements N blocks deep, report throughput
+int tetris_perft(int depth, const struct game_config_t *config, const char *board_file)
+{
+    struct tetris_board_t board;
+    struct timespec begin, end;
+    struct tetris_scene_t game;
+    int types[MAX_PERFT_DEPTH];
+    int i, color;
+
+    memset(&board, 0, sizeof(struct tetris_board_t));
+    if (board_file != NULL && 0 != board_load(&board, board_file))
+    {
+        perror("board_load");
+
+        return -1;
+    }
+
+    // Same sequence a game of this config would get
+    memset(&game, 0, sizeof(struct tetris_scene_t));
+    game_init(&game, config);
+    for (i = 0; i < depth; i ++)
+    {
+        queue_fill(&game.queue, config->randomizer, &game.rng, 0);
+        types[i] = queue_pop(&game.queue, &color);
+    }
+
+    printf("perft seed %llu\n", (unsigned long long int)game.config.seed);
+    for (i = 1; i <= depth; i ++)
+    {
+        unsigned long long int nodes, leaves;
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        leaves = perft(&board, types, i, &nodes);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        double elapsed = (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) / 1e9;
+        printf("depth %d : %llu placements, %llu nodes, %.3fs, %.0f nodes/sec\n",
+            i, leaves, nodes, elapsed, elapsed > 0 ? nodes / elapsed : 0);
+    }
+
+    return 0;
+}
+
+// Best scores from the local store
+int tetris_scores(const char *dir, int k, int level, const char *player)
+{
+    struct score_record_t *list;
+    struct score_db_t *db;
+    char when[32];
+    int i, n;
+
+    if (NULL == (db = scores_open(dir)))
+    {
+        perror("scores_open");
+
+        return -1;
+    }
+
+    list = malloc(sizeof(struct score_record_t) * k);
+    if (list == NULL)
+    {
+        scores_close(db);
+
+        return -1;
+    }
+
+    uint64_t begin = perf_now();
+    n = scores_query(db, level, player, k, list);
+    uint64_t elapsed = perf_now() - begin;
+
+    printf("%4s  %-16s %8s %7s %6s %5s %8s  %-20s %-16s %s\n", "#", "Player", "Score", "Blocks", "Lines", "Level", "Seconds", "Seed", "Date", "Replay");
+    for (i = 0; i < n; i ++)
+    {
+        time_t t = list[i].time;
+        strftime(when, sizeof(when), "%Y-%m-%d %H:%M", localtime(&t));
+        printf("%4d  %-16.*s %8d %7d %6d %5d %8.2f  %-20llu %-16s %08x\n",
+            i + 1, SCORE_PLAYER, list[i].player, list[i].score, list[i].blocks, list[i].lines, list[i].level,
+            list[i].duration_ms / 1000.0, (unsigned long long int)list[i].seed, when, list[i].replay);
+    }
+
+    printf("%d record(s) in %.1f us\n", n, elapsed / 1e3);
+    free(list);
+    scores_close(db);
+
+    return 0;
+}
+
+// Finished game is saved while the ending screen is up
+struct score_save_t
+{
+    const char         *dir;
+    struct score_record_t
+                        record;
+};
+
+static void * _save_score(void *arg)
+{
+    struct score_save_t *job = arg;
+    struct score_db_t *db = scores_open(job->dir);
+    if (db != NULL)
+    {
+        scores_append(db, &job->record, 1);
+        scores_close(db);
+    }
+
+    return NULL;
+}
+
+/* }}} */
+
 // Main frame
 void tetris_main()
 {
@@ -1022,6 +1165,26 @@ void tetris_main()
 // Hint for inteliisence
 extern char *optarg;
 
+// Long only options
+enum long_option_e
+{
+    OPT_STATS = 256,
+    OPT_GRAVITY,
+    OPT_BOT_PIPE,
+    OPT_BOT,
+    OPT_BOT_ARGS,
+    OPT_BOT_BUDGET,
+    OPT_SHM,
+    OPT_PLAYER,
+    OPT_SCORES,
+    OPT_TOP,
+    OPT_RECORD,
+    OPT_KEYFRAME,
+    OPT_REPLAY,
+    OPT_TRACE,
+    OPT_LOG,
+};
+
 // I wrote this console game
 // I like console games
 // I ... Happy 1024
@@ -1029,22 +1192,170 @@ int main(int argc, char *argv[])
 {
     memset(&scene, 0, sizeof(struct tetris_scene_t));
 
+    static struct option long_options[] = {
+        {"level",   required_argument, NULL, 'l'},
+        {"perft",   required_argument, NULL, 'P'},
+        {"seed",    required_argument, NULL, 'S'},
+        {"board",   required_argument, NULL, 'B'},
+        {"stats",   required_argument, NULL, OPT_STATS},
+        {"gravity", required_argument, NULL, OPT_GRAVITY},
+        {"preview", required_argument, NULL, 'n'},
+        {"randomizer", required_argument, NULL, 'r'},
+        {"bot-pipe", no_argument,      NULL, OPT_BOT_PIPE},
+        {"bot",     required_argument, NULL, OPT_BOT},
+        {"bot-args", required_argument, NULL, OPT_BOT_ARGS},
+        {"bot-budget", required_argument, NULL, OPT_BOT_BUDGET},
+        {"shm",     required_argument, NULL, OPT_SHM},
+        {"player",  required_argument, NULL, OPT_PLAYER},
+        {"scores",  required_argument, NULL, OPT_SCORES},
+        {"top",     required_argument, NULL, OPT_TOP},
+        {"record",  required_argument, NULL, OPT_RECORD},
+        {"keyframe", required_argument, NULL, OPT_KEYFRAME},
+        {"replay",  required_argument, NULL, OPT_REPLAY},
+        {"trace",   required_argument, NULL, OPT_TRACE},
+        {"log",     required_argument, NULL, OPT_LOG},
+        {"help",    no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
     int c;
-    int level = DEFAULT_TETRIS_LEVEL;
-    while (-1 != (c = getopt(argc, argv, "l:h")))
+    struct game_config_t config;
+    int perft_depth = 0;
+    char *board_file = NULL;
+    char *stats_file = NULL;
+    bool bot_pipe = FALSE;
+    char *bot_file = NULL;
+    char *bot_args = NULL;
+    uint64_t bot_budget = 0;
+    char *shm_name = NULL;
+    char *player = NULL;
+    char *scores_dir = NULL;
+    char scores_home[1024];
+    int top = 0;
+    bool level_given = FALSE;
+    char *record_file = NULL;
+    char *replay_file = NULL;
+    char *trace_file = NULL;
+    char *log_file = NULL;
+    struct replay_t *replay = NULL;
+    int keyframe = REPLAY_KEYFRAME_BLOCKS;
+    game_config_default(&config);
+    while (-1 != (c = getopt_long(argc, argv, "l:P:S:B:n:r:h", long_options, NULL)))
     {
         switch (c)
         {
             case 'l' :
-                level = atoi(optarg);
-                if (level > MAX_TETRIS_LEVEL)
+                level_given = TRUE;
+                config.level = atoi(optarg);
+                if (config.level > MAX_TETRIS_LEVEL)
+                {
+                    config.level = MAX_TETRIS_LEVEL;
+                }
+
+                if (config.level < MIN_TETRIS_LEVEL)
+                {
+                    config.level = MIN_TETRIS_LEVEL;
+                }
+
+                break;
+            case 'n' :
+                config.preview = atoi(optarg);
+                if (config.preview > MAX_PREVIEW)
+                {
+                    config.preview = MAX_PREVIEW;
+                }
+
+                if (config.preview < MIN_PREVIEW)
+                {
+                    config.preview = MIN_PREVIEW;
+                }
+
+                break;
+            case 'r' :
+                if (0 > (config.randomizer = randomizer_by_name(optarg)))
                 {
-                    level = MAX_TETRIS_LEVEL;
+                    printf("Unknown randomizer <%s>\n", optarg);
+                    exit(-1);
                 }
 
-                if (level < MIN_TETRIS_LEVEL)
+                break;
+            case 'P' :
+                perft_depth = atoi(optarg);
+                if (perft_depth > MAX_PERFT_DEPTH)
                 {
-                    level = MIN_TETRIS_LEVEL;
+                    perft_depth = MAX_PERFT_DEPTH;
+                }
+
+                break;
+            case 'S' :
+                config.seed = strtoull(optarg, NULL, 10);
+
+                break;
+            case 'B' :
+                board_file = optarg;
+
+                break;
+            case OPT_STATS :
+                stats_file = optarg;
+
+                break;
+            case OPT_BOT_PIPE :
+                bot_pipe = TRUE;
+
+                break;
+            case OPT_BOT :
+                bot_file = optarg;
+
+                break;
+            case OPT_BOT_ARGS :
+                bot_args = optarg;
+
+                break;
+            case OPT_BOT_BUDGET :
+                bot_budget = strtoull(optarg, NULL, 10) * 1000;
+
+                break;
+            case OPT_SHM :
+                shm_name = optarg;
+
+                break;
+            case OPT_PLAYER :
+                player = optarg;
+
+                break;
+            case OPT_SCORES :
+                scores_dir = optarg;
+
+                break;
+            case OPT_TOP :
+                top = atoi(optarg);
+
+                break;
+            case OPT_RECORD :
+                record_file = optarg;
+
+                break;
+            case OPT_KEYFRAME :
+                keyframe = atoi(optarg);
+
+                break;
+            case OPT_REPLAY :
+                replay_file = optarg;
+
+                break;
+            case OPT_TRACE :
+                trace_file = optarg;
+
+                break;
+            case OPT_LOG :
+                log_file = optarg;
+
+                break;
+            case OPT_GRAVITY :
+                if (0 != set_gravity_curve(optarg))
+                {
+                    printf("Invalid gravity curve <%s>\n", optarg);
+                    exit(-1);
                 }
 
                 break;
@@ -1054,10 +1365,31 @@ int main(int argc, char *argv[])
                 printf("<KEY-LEFT / w> <KEY-RIGHT / d> <KEY-DOWN / s> for block movment\n");
                 printf("<j> <k> for block rotation\n");
                 printf("<KEY-SPACE> <KEY-ENTER> for fall off\n");
+                printf("<p> to toggle performance overlay\n");
                 printf("<KEY-ESC> to quit game\n");
 
-                printf("\t-s : Game level [1 - 9], default <%d>\n", DEFAULT_TETRIS_LEVEL);
-                printf("\t-h : Print this topic\n");
+                printf("\t-l, --level : Game level [%d - %d], default <%d>\n", MIN_TETRIS_LEVEL, MAX_TETRIS_LEVEL, DEFAULT_TETRIS_LEVEL);
+                printf("\t--gravity <g1,g2,...> : Rows per tick (10ms) of each level from 1, %d drops instantly\n", GRAVITY_INSTANT_ROWS);
+                printf("\t-n, --preview <n> : Upcoming blocks shown [%d - %d], default <%d>\n", MIN_PREVIEW, MAX_PREVIEW, DEFAULT_PREVIEW);
+                printf("\t-r, --randomizer <uniform|bag|history> : Block generator, default <uniform>\n");
+                printf("\t-P, --perft <depth> : Count reachable placements [1 - %d] and exit\n", MAX_PERFT_DEPTH);
+                printf("\t-S, --seed <seed> : Seed of block sequence\n");
+                printf("\t-B, --board <file> : Start board for perft / bot pipe, '.' for empty cells\n");
+                printf("\t--bot-pipe : No screen, play by commands on stdin, state on stdout\n");
+                printf("\t--bot <lib.so> : Bot plugin places every block, see src/tetris_bot.h\n");
+                printf("\t--bot-args <args> : Argument string passed to bot plugin\n");
+                printf("\t--bot-budget <us> : Ignore bot answers slower than this\n");
+                printf("\t--player <name> : Name in high score store, default $USER\n");
+                printf("\t--scores <dir> : High score store, default <$HOME/.tetris1024>\n");
+                printf("\t--top <k> : Print best k scores and exit, -l / --player filter\n");
+                printf("\t--record <file> : Record game for replay\n");
+                printf("\t--keyframe <n> : Keyframe every n pieces in recordings, default <%d>\n", REPLAY_KEYFRAME_BLOCKS);
+                printf("\t--replay <file> : View recording, <LEFT> <RIGHT> / <UP> <DOWN> / <PGUP> <PGDN> seek, <SPACE> play, q quit\n");
+                printf("\t--trace <file> : Write a Chrome trace event timeline of ticks, input and rendering on exit\n");
+                printf("\t--log <file> : Binary event log of the session, read with tetris-evlog\n");
+                printf("\t--shm <name> : Mirror live state into shared memory /dev/shm/<name>, see src/tetris_shm.h\n");
+                printf("\t--stats <file> : Write session statistics on exit, CSV for *.csv, JSON otherwise\n");
+                printf("\t-h, --help : Print this topic\n");
 
                 exit(0);
 
@@ -1067,9 +1399,113 @@ int main(int argc, char *argv[])
         }
     }
 
-    scene.level = level;
-    scene.speed = calculate_speed(level);
-    scene.status = STATUS_PREPARE;
+    if (scores_dir == NULL && getenv("HOME") != NULL)
+    {
+        snprintf(scores_home, sizeof(scores_home), "%s/.tetris1024", getenv("HOME"));
+        scores_dir = scores_home;
+    }
+
+    if (top > 0)
+    {
+        if (scores_dir == NULL)
+        {
+            printf("No high score store, use --scores <dir>\n");
+
+            return -1;
+        }
+
+        return tetris_scores(scores_dir, top, level_given ? config.level : -1, player);
+    }
+
+    if (player == NULL)
+    {
+        player = (getenv("USER") != NULL) ? getenv("USER") : "player";
+    }
+
+    board_init();
+    if (perft_depth > 0)
+    {
+        return tetris_perft(perft_depth, &config, board_file);
+    }
+
+    game_init(&scene, &config);
+    if (bot_file != NULL && NULL == (bot_plugin = bot_plugin_open(bot_file, bot_args, bot_budget)))
+    {
+        return -1;
+    }
+
+    if (bot_pipe)
+    {
+        // Run until topped out, bot may quit earlier
+        scene.egg = 0;
+        if (board_file != NULL && 0 != board_load(&scene.board, board_file))
+        {
+            perror("board_load");
+
+            return -1;
+        }
+
+        botpipe_run(&scene, STDIN_FILENO, stdout);
+        if (stats_file != NULL && 0 != stats_write(&scene, stats_file))
+        {
+            perror("stats_write");
+        }
+
+        return 0;
+    }
+
+    // Viewer plays nothing live, there is no game to record or mirror
+    if (replay_file != NULL && (record_file != NULL || shm_name != NULL))
+    {
+        printf("--replay can not be used with --record or --shm\n");
+
+        return -1;
+    }
+
+    if (replay_file != NULL && NULL == (replay = replay_open(replay_file)))
+    {
+        printf("Can not read replay <%s>\n", replay_file);
+
+        return -1;
+    }
+
+    if (record_file != NULL && NULL == (recorder = replay_create(record_file, &scene, keyframe)))
+    {
+        perror("replay_create");
+
+        return -1;
+    }
+
+    if (trace_file != NULL)
+    {
+        if (0 != trace_open(trace_file))
+        {
+            perror("trace_open");
+
+            return -1;
+        }
+
+        trace_thread("render");
+    }
+
+    if (log_file != NULL && 0 != evlog_open(log_file))
+    {
+        perror("evlog_open");
+
+        return -1;
+    }
+
+    if (shm_name != NULL)
+    {
+        if (0 != shm_export_open(shm_name))
+        {
+            perror("shm_open");
+
+            return -1;
+        }
+
+        shm_export_publish(&scene);
+    }
 
     initscr();
     check_window();
@@ -1080,16 +1516,62 @@ int main(int argc, char *argv[])
     timeout(-1);
     start_color();
     color_pairs();
+    glyph_cache();
 
     // Draw scene
     tetris_main();
+    if (replay != NULL)
+    {
+        // Layout follows the recorded config
+        replay_seek(replay, 0, &scene);
+        check_window();
+        tetris_interface();
+        tetris_replay_loop(replay);
+        replay_close(replay);
+        trace_close();
+        evlog_close();
+        curs_set(2);
+        echo();
+        endwin();
+        bot_plugin_close(bot_plugin);
+
+        return 0;
+    }
+
     tetris_splash();
     tetris_interface();
 
     // Play loop
     _render_boxes();
     _render_playground();
+    _render_flush();
     tetris_loop();
+    if (recorder != NULL && 0 != replay_finish(recorder, &scene))
+    {
+        perror("replay_finish");
+    }
+
+    if (0 != trace_close())
+    {
+        perror("trace_close");
+    }
+
+    if (0 != evlog_close())
+    {
+        perror("evlog_close");
+    }
+
+    // Append and fsync in background, ending screen shows at once
+    static struct score_save_t save;
+    pthread_t saver;
+    bool saving = FALSE;
+    if (scores_dir != NULL && (STATUS_OVER == scene.status || STATUS_EGG == scene.status))
+    {
+        save.dir = scores_dir;
+        scores_record(&scene, player, &save.record);
+        saving = (0 == pthread_create(&saver, NULL, _save_score, &save));
+    }
+
     if (STATUS_OVER == scene.status)
     {
         tetris_gameover();
@@ -1103,11 +1585,24 @@ int main(int argc, char *argv[])
         tetris_quit();
     }
 
+    if (saving)
+    {
+        pthread_join(saver, NULL);
+    }
+
     curs_set(2);
     echo();
     //nocbreak();
     endwin();
 
+    if (stats_file != NULL && 0 != stats_write(&scene, stats_file))
+    {
+        perror("stats_write");
+    }
+
+    bot_plugin_close(bot_plugin);
+    shm_export_close();
+
     return 0;
 }
 
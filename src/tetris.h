@@ -27,7 +27,10 @@
  * @since 10/17/2021
  */
 
+#include <getopt.h>
 #include <signal.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -50,16 +53,82 @@
 #define MSG_BOX_WIDTH                   16
 #define MSG_BOX_HEIGHT                  7
 #define NEXT_BOX_WIDTH                  16
-#define NEXT_BOX_HEIGHT                 9
+#define NEXT_BOX_HEIGHT(n)              (5 + 4 * (n))
 #define TRACE_BOX_WIDTH                 16
-#define TRACE_BOX_HEIGHT                7
+#define TRACE_BOX_HEIGHT                9
+
+#define PERF_RING                       256
+#define TRACE_RING                      (1 << 16)
+#define TRACE_THREADS                   8
+
+#define SIM_PERIOD_NS                   10000000
+#define RENDER_POLL_MS                  5
+#define INPUT_RING                      64
+
+#define REPLAY_HASH_SEED                2166136261u
+#define REPLAY_MAGIC                    "tetrply1"
+#define REPLAY_INDEX_MAGIC              "tetridx1"
+#define REPLAY_VERSION                  2
+#define REPLAY_KEYFRAME_BLOCKS          100
+#define REPLAY_PLAY_MS                  200
+#define VERSUS_DRAW                     2
+#define VERSUS_RUNNING                  (-1)
+#define CORPUS_MAGIC                    "tetcorp1"
+#define CORPUS_INDEX_MAGIC              "tetcidx1"
+#define CORPUS_VERSION                  2
+#define CORPUS_BLOCK_GAMES              256
+#define CORPUS_BLOCK_EVENTS             (1 << 20)
+#define CORPUS_ZLIB                     1
+#define EVLOG_MAGIC                     "tetlog01"
+#define EVLOG_VERSION                   1
+#define EVLOG_RING                      (1 << 14)
+#define EVLOG_THREADS                   8
+#define EVLOG_FLUSH_MS                  100
+
+#define SCORE_PLAYER                    24
+#define SCORES_TAIL_MAX                 4096
+
+#define VECENV_COLUMNS                  (PLAYGROUND_WIDTH + 3)
+#define VECENV_ACTIONS                  (4 * VECENV_COLUMNS)
+
+#define QUEUE_SIZE                      16
+#define QUEUE_BATCH                     8
+#define MIN_PREVIEW                     1
+#define MAX_PREVIEW                     6
+#define DEFAULT_PREVIEW                 1
+#define TGM_HISTORY                     4
+#define TGM_ROLLS                       6
 
 #define DEFAULT_TETRIS_LEVEL            3
 #define MIN_TETRIS_LEVEL                1
-#define MAX_TETRIS_LEVEL                9
+#define MAX_TETRIS_LEVEL                20
+
+// Gravity in rows per tick, 16.16 fixed point
+#define GRAVITY_ONE                     65536
+#define GRAVITY_INSTANT_ROWS            20
 
 #define EGG_SCORE                       1024
 
+#define MAX_PLACEMENTS                  256
+#define BOARD_PAD                       4
+#define BOARD_KICKS                     5
+#define EVAL_BATCH                      16
+#define MAX_PERFT_DEPTH                 8
+
+// Static probes for perf / bpftrace, provider tetris. Built with -DTETRIS_USDT, a nop otherwise
+#ifdef TETRIS_USDT
+#include <sys/sdt.h>
+#define PROBE(name)                     DTRACE_PROBE(tetris, name)
+#define PROBE1(name, a)                 DTRACE_PROBE1(tetris, name, a)
+#define PROBE2(name, a, b)              DTRACE_PROBE2(tetris, name, a, b)
+#define PROBE3(name, a, b, c)           DTRACE_PROBE3(tetris, name, a, b, c)
+#else
+#define PROBE(name)                     do {} while (0)
+#define PROBE1(name, a)                 do {} while (0)
+#define PROBE2(name, a, b)              do {} while (0)
+#define PROBE3(name, a, b, c)           do {} while (0)
+#endif
+
 /* {{{ Structures */
 
 // Scene
@@ -71,16 +140,55 @@ enum scene_status_e
     STATUS_EGG,
 };
 
-struct tetris_scene_t
+// What a game step changed, tells the renderer what to redraw
+enum game_event_e
 {
-    int                 win_width;
-    int                 win_height;
-    enum scene_status_e status;
-    int                 score;
-    int                 level;
-    int                 blocks;
-    int                 speed;
-    char                playground[PLAYGROUND_HEIGHT][PLAYGROUND_WIDTH];
+    EVENT_SPAWN = 1,
+    EVENT_MOVE = 2,
+    EVENT_LOCK = 4,
+    EVENT_CLEAR = 8,
+    EVENT_END = 16,
+};
+
+// Player inputs
+enum game_key_e
+{
+    GAME_KEY_NONE,
+    GAME_KEY_LEFT,
+    GAME_KEY_RIGHT,
+    GAME_KEY_DOWN,
+    GAME_KEY_DROP,
+    GAME_KEY_ROTATE_CCW,
+    GAME_KEY_ROTATE_CW,
+};
+
+// Playground stored as row bitmasks, bit x is column x, row 0 is the bottom
+struct tetris_board_t
+{
+    uint16_t            rows[PLAYGROUND_HEIGHT];
+};
+
+// Candidate boards for batch evaluation, structure of arrays : rows[y][lane]
+struct board_batch_t
+{
+    uint16_t            rows[PLAYGROUND_HEIGHT][EVAL_BATCH] __attribute__((aligned(32)));
+};
+
+// Heuristic features per lane, full rows are treated as cleared
+struct board_eval_t
+{
+    uint16_t            height[EVAL_BATCH] __attribute__((aligned(32)));
+    uint16_t            holes[EVAL_BATCH] __attribute__((aligned(32)));
+    uint16_t            bumpiness[EVAL_BATCH] __attribute__((aligned(32)));
+    uint16_t            lines[EVAL_BATCH] __attribute__((aligned(32)));
+};
+
+struct eval_weights_t
+{
+    float               height;
+    float               holes;
+    float               bumpiness;
+    float               lines;
 };
 
 static char *title_t[] = {
@@ -236,6 +344,14 @@ struct pos_t {
     int y;
 };
 
+// Final resting position of a block
+struct placement_t {
+    signed char         x;
+    signed char         y;
+    unsigned char       dir;
+    unsigned char       type;
+};
+
 typedef struct tetris_block_t {
     enum block_type_e
                         type;
@@ -247,6 +363,74 @@ typedef struct tetris_block_t {
     bool                dropped;
 } BLOCK;
 
+// Block generators
+enum randomizer_e
+{
+    RANDOMIZER_UNIFORM,
+    RANDOMIZER_BAG,
+    RANDOMIZER_HISTORY,
+};
+
+// Upcoming blocks, filled a batch at a time ahead of spawning
+struct tetris_queue_t
+{
+    unsigned char       types[QUEUE_SIZE];
+    unsigned char       colors[QUEUE_SIZE];
+    unsigned int        head;
+    unsigned int        tail;
+    unsigned char       history[TGM_HISTORY];
+    bool                first;
+};
+
+// Everything a game is started from, same config and seed give the same game
+struct game_config_t
+{
+    int                 level;
+    uint64_t            seed;
+    int                 preview;
+    enum randomizer_e   randomizer;
+};
+
+// Per session counters, bumped in place by the engine, never allocates
+struct tetris_stats_t
+{
+    unsigned int        pieces[8];
+    unsigned int        clears[5];
+    unsigned int        keys;
+    int                 peak_height;
+    unsigned long long int
+                        level_ticks[MAX_TETRIS_LEVEL + 1];
+};
+
+// Complete state of one game, plain data so headless games can run side by side
+struct tetris_scene_t
+{
+    int                 win_width;
+    int                 win_height;
+    enum scene_status_e status;
+    int                 score;
+    int                 level;
+    int                 blocks;
+    unsigned int        gravity;
+    unsigned int        gravity_acc;
+    int                 lines;
+    int                 egg;
+    unsigned long long int
+                        timer_counter;
+    unsigned int        version;
+    uint32_t            replay_hash;
+    uint64_t            rng;
+    struct game_config_t
+                        config;
+    struct tetris_board_t
+                        board;
+    BLOCK               curr;
+    struct tetris_queue_t
+                        queue;
+    struct tetris_stats_t
+                        stats;
+};
+
 // Block maps
 static int block_L[4] = {
     /*
@@ -332,27 +516,494 @@ static int block_T[4] = {
     // 0b0000000001001110, 0b0000001001100010, 0b0000111001000000, 0b0000100011001000
 };
 
-/* }}} */
+// Keys from input side to simulation, one producer and one consumer
+struct input_ring_t
+{
+    unsigned char       keys[INPUT_RING];
+    unsigned int        head;
+    unsigned int        tail;
+};
 
-// FUnctions
+// Scene snapshots handed from simulation to renderer, neither side ever waits
+struct snapshot_buffer_t
+{
+    struct tetris_scene_t
+                        slots[3];
+    unsigned int        back;
+    unsigned int        middle;
+    unsigned int        front;
+};
+
+// Caller owned outputs of a batch of games, contiguous per game :
+// rows[n][PLAYGROUND_HEIGHT], queue[n][preview], mask[n][VECENV_ACTIONS] (may be NULL), others [n]
+struct vecenv_obs_t
+{
+    uint16_t           *rows;
+    unsigned char      *piece;
+    unsigned char      *queue;
+    float              *reward;
+    unsigned char      *done;
+    unsigned char      *mask;
+};
+
+// One finished game in the high score log, fixed size, check is FNV-1a of the bytes before it
+struct score_record_t
+{
+    char                player[SCORE_PLAYER];
+    int32_t             score;
+    int32_t             blocks;
+    int32_t             level;
+    int32_t             lines;
+    uint64_t            seed;
+    uint32_t            duration_ms;
+    uint32_t            replay;
+    int64_t             time;
+    uint32_t            reserved;
+    uint32_t            check;
+};
+
+// Replay records, see replay.c for the file layout
+enum replay_kind_e
+{
+    REPLAY_KEY = 'K',
+    REPLAY_PLACE = 'P',
+    REPLAY_KEYFRAME = 'F',
+};
+
+struct replay_header_t
+{
+    char                magic[8];
+    uint32_t            version;
+    uint32_t            scene_size;
+    uint32_t            keyframe;
+    uint32_t            reserved;
+};
+
+struct replay_event_t
+{
+    uint32_t            tick;
+    char                kind;
+    signed char         x;
+    signed char         y;
+    unsigned char       v;
+};
+
+struct replay_index_t
+{
+    uint32_t            blocks;
+    uint32_t            tick;
+    uint64_t            offset;
+};
+
+struct replay_footer_t
+{
+    uint64_t            index_offset;
+    uint32_t            count;
+    uint32_t            blocks;
+    uint64_t            end_tick;
+    char                magic[8];
+};
+
+// Two games on one piece sequence, cleared lines turn into rows sent by attack[lines]
+struct versus_t
+{
+    struct tetris_scene_t
+                        games[2];
+    int                 attack[5];
+    int                 pending[2];
+    uint64_t            rng[2];
+    int                 turns;
+    int                 winner;
+    int                 sent[2];
+};
+
+// Replay corpus, see corpus.c for the file layout
+enum corpus_column_e
+{
+    CORPUS_COL_SEED,
+    CORPUS_COL_CONFIG,
+    CORPUS_COL_OUTCOME,
+    CORPUS_COL_COUNT,
+    CORPUS_COL_TICK,
+    CORPUS_COL_KIND,
+    CORPUS_COL_KEY,
+    CORPUS_COL_PLACE,
+    CORPUS_COLUMNS
+};
+
+struct corpus_header_t
+{
+    char                magic[8];
+    uint32_t            version;
+    uint32_t            flags;
+    uint32_t            block_games;
+    uint32_t            reserved;
+};
+
+struct corpus_block_t
+{
+    uint32_t            games;
+    uint32_t            events;
+    uint32_t            raw[CORPUS_COLUMNS];
+    uint32_t            stored[CORPUS_COLUMNS];
+};
+
+struct corpus_index_t
+{
+    uint32_t            first;
+    uint32_t            games;
+    uint64_t            offset;
+};
+
+struct corpus_footer_t
+{
+    uint64_t            index_offset;
+    uint32_t            blocks;
+    uint32_t            games;
+    char                magic[8];
+};
+
+// One game of a corpus : how it started, how it ended and what was played in between
+struct corpus_game_t
+{
+    struct game_config_t
+                        config;
+    unsigned int        gravity;
+    int                 egg;
+    enum scene_status_e status;
+    int                 score;
+    int                 blocks;
+    int                 lines;
+    uint64_t            end_tick;
+    uint32_t            replay_hash;
+    uint32_t            events_count;
+    const struct replay_event_t
+                       *events;
+};
 
-// Create tetris block by given type
-BLOCK * new_block();
+// Binary event log, a : b arguments by type
+enum evlog_type_e
+{
+    EVLOG_NONE,
+    EVLOG_TICK,                         // events : tick duration ns
+    EVLOG_SPAWN,                        // block type : blocks
+    EVLOG_KEY,                          // key | accepted << 8 : timer counter
+    EVLOG_LOCK,                         // block type : x | y << 8 | direction << 16
+    EVLOG_CLEAR,                        // lines : score
+    EVLOG_END,                          // status : score
+    EVLOG_FRAME,                        // 0 : render ns
+    EVLOG_DROPPED,                      // thread : records lost to a full ring
+    EVLOG_TYPES
+};
 
-// Delete (free) block
-void del_block(BLOCK *);
+struct evlog_header_t
+{
+    char                magic[8];
+    uint32_t            version;
+    uint32_t            record_size;
+    uint64_t            origin_ns;
+    int64_t             wall_s;
+};
 
-// Rotate block
-int try_rotate_block(BLOCK *, bool, enum block_direction_e *);
+// Fixed size record, ns on the monotonic clock, thread numbered from 1 in order of first event
+struct evlog_record_t
+{
+    uint64_t            ns;
+    uint8_t             type;
+    uint8_t             thread;
+    uint16_t            a;
+    uint32_t            b;
+};
+
+// Live performance figures, refreshed once a second
+struct perf_report_t
+{
+    unsigned int        fps;
+    double              tick_mean_us;
+    double              tick_p99_us;
+    double              render_us;
+    // Whole process from /proc/self/io : bytes written anywhere (terminal, logs, replays), read / write calls
+    unsigned long long int
+                        written_ps;
+    unsigned long long int
+                        io_calls_ps;
+    bool                io;
+};
 
-// Check solid
-bool check_block_solid(BLOCK *, int, int, int, int, int);
+/* }}} */
+
+// FUnctions
+
+// Create tetris block by given type and color
+void new_block(BLOCK *, int, int);
+
+// Block map of type and direction
+int tile_block(enum block_type_e, enum block_direction_e);
 
 // Generate random integer from urandom device
 unsigned int get_random();
 
-// Level => Speed rate
-int calculate_speed(int);
+// Level => Gravity
+unsigned int calculate_gravity(int);
+
+// Override level curve, comma separated rows per tick from level 1
+int set_gravity_curve(const char *);
+
+// Seed / step the deterministic generator used by headless games
+void rng_seed(uint64_t *, uint64_t);
+unsigned int rng_next(uint64_t *);
+
+// Block maps as row masks [type][direction][tile row], bit x is column x
+extern uint16_t block_rows[8][4][4];
+
+// Build row masks of all block maps, call once before any board operation
+void board_init();
+
+// Check whether block collides with walls, floor or solid cells
+bool board_collide(const struct tetris_board_t *, int, int, int, int);
+
+// Test single cell
+bool board_cell(const struct tetris_board_t *, int, int);
+
+// Rotate with kicks, x moved by the kick that fits. New direction, -1 if none fits
+int board_rotate(const struct tetris_board_t *, int, int, bool, int *, int);
+
+// Rows block can fall before landing
+int board_drop_distance(const struct tetris_board_t *, int, int, int, int);
+
+// Merge block into board
+void board_lock(struct tetris_board_t *, int, int, int, int);
+
+// Remove full rows, returns number of rows removed
+int board_clear_lines(struct tetris_board_t *);
+
+// Push n rows full but column hole in from the bottom, TRUE if blocks went over the top
+bool board_garbage(struct tetris_board_t *, int, int);
+
+// Load board from text file, '.' for empty, top line is the top row
+int board_load(struct tetris_board_t *, const char *);
+
+// Copy board into lane of batch
+void board_batch_put(struct board_batch_t *, int, const struct tetris_board_t *);
+
+// Heights, holes, bumpiness and completed lines of all lanes
+void board_eval_batch(const struct board_batch_t *, struct board_eval_t *);
+
+// Weighted sum of features, first N lanes
+void board_score_batch(const struct eval_weights_t *, const struct board_eval_t *, int, float *);
+
+// Name of evaluation kernel selected by CPU features
+const char * board_eval_kernel();
+
+// Classic defaults : level 3, one preview, uniform generator, seed from urandom
+void game_config_default(struct game_config_t *);
+
+// Reset game state, 0 seed draws from urandom
+void game_init(struct tetris_scene_t *, const struct game_config_t *);
+
+// Spawn next block if none is falling, returns events
+int game_spawn(struct tetris_scene_t *);
+
+// Advance one timer tick (10ms), returns events
+int game_tick(struct tetris_scene_t *);
+
+// Apply player input, returns TRUE if block moved
+bool game_input(struct tetris_scene_t *, enum game_key_e);
+
+// Lock falling block at given placement, returns events
+int game_place(struct tetris_scene_t *, const struct placement_t *);
+
+// Falling block, NULL if none
+BLOCK * game_curr(struct tetris_scene_t *);
+
+// Empty queue and reset generator state
+void queue_init(struct tetris_queue_t *);
+
+// Top queue up by whole batches until it holds more than N blocks
+void queue_fill(struct tetris_queue_t *, enum randomizer_e, uint64_t *, int);
+
+// Take head of queue, returns block type
+int queue_pop(struct tetris_queue_t *, int *);
+
+// N-th upcoming block without taking it, returns block type
+int queue_peek(const struct tetris_queue_t *, int, int *);
+
+// Randomizer by name, -1 if unknown
+int randomizer_by_name(const char *);
+
+extern const struct eval_weights_t bot_default_weights;
+
+// Write session statistics, CSV rows are appended if path ends with .csv, JSON otherwise
+int stats_write(struct tetris_scene_t *, const char *);
+
+// Queue a key, FALSE if ring is full
+bool input_push(struct input_ring_t *, enum game_key_e);
+
+// Take oldest key, GAME_KEY_NONE if ring is empty
+enum game_key_e input_pop(struct input_ring_t *);
+
+// Seed all slots with the same scene
+void snapshot_init(struct snapshot_buffer_t *, const struct tetris_scene_t *);
+
+// Copy scene into back slot and make it the latest
+void snapshot_publish(struct snapshot_buffer_t *, const struct tetris_scene_t *);
+
+// Latest scene if published since last call, NULL otherwise. Stays valid until next call
+struct tetris_scene_t * snapshot_acquire(struct snapshot_buffer_t *);
+
+// Batch of independent headless games, action = dir * VECENV_COLUMNS + x + 3 drops straight from spawn
+struct vecenv_t;
+
+struct vecenv_t * vecenv_create(int, const struct game_config_t *);
+void vecenv_destroy(struct vecenv_t *);
+int vecenv_size(const struct vecenv_t *);
+
+// Current observations, rewards and done flags cleared
+void vecenv_observe(struct vecenv_t *, const struct vecenv_obs_t *);
+
+// Place one block in every game, games that ended are restarted before observing.
+// A game whose mask is all zero has topped out, any action ends it
+void vecenv_step(struct vecenv_t *, const int *, const struct vecenv_obs_t *);
+
+// Bot plugin loaded from shared library, see tetris_bot.h
+struct bot_plugin_t;
+
+// Load bot shared library, NULL on failure. Budget of each decision in ns, 0 for none
+struct bot_plugin_t * bot_plugin_open(const char *, const char *, uint64_t);
+
+// Placement plugin picks for the falling block without locking it, -1 if it passed
+int bot_plugin_choose(struct bot_plugin_t *, const struct tetris_scene_t *, struct placement_t *);
+
+// Let plugin place the falling block, events of the lock or 0 if it passed. Placement copied out if not NULL
+int bot_plugin_place(struct bot_plugin_t *, struct tetris_scene_t *, struct placement_t *);
+
+void bot_plugin_close(struct bot_plugin_t *);
+
+// High score store, append only log plus mmap'd sorted index
+struct score_db_t;
+
+// Open store in directory, created if missing. NULL on failure
+struct score_db_t * scores_open(const char *);
+void scores_close(struct score_db_t *);
+
+// Record of a finished game
+void scores_record(const struct tetris_scene_t *, const char *, struct score_record_t *);
+
+// Append n records and sync, index is rebuilt once the unindexed tail grows past SCORES_TAIL_MAX
+int scores_append(struct score_db_t *, struct score_record_t *, int);
+
+// Sort whole log into a fresh index, replaced atomically
+int scores_rebuild(struct score_db_t *);
+
+// Best k records, level < 0 and player NULL match all. Returns count written
+int scores_query(struct score_db_t *, int, const char *, int, struct score_record_t *);
+
+// Replay recorder, keys before and placements after a tick, keyframe every N spawns
+struct replay_writer_t;
+
+struct replay_writer_t * replay_create(const char *, const struct tetris_scene_t *, int);
+void replay_key(struct replay_writer_t *, uint32_t, enum game_key_e);
+void replay_place(struct replay_writer_t *, uint32_t, const struct placement_t *);
+void replay_tick(struct replay_writer_t *, const struct tetris_scene_t *, int);
+
+// Write keyframe index and close
+int replay_finish(struct replay_writer_t *, const struct tetris_scene_t *);
+
+// Replay reader, file is mapped. Recordings without index are scanned once. board_init first
+struct replay_t;
+
+struct replay_t * replay_open(const char *);
+void replay_close(struct replay_t *);
+int replay_blocks(const struct replay_t *);
+int replay_keyframe_interval(const struct replay_t *);
+
+// Scene at end of the tick block n spawned in, returns block reached
+int replay_seek(const struct replay_t *, int, struct tetris_scene_t *);
+
+// Re-simulate everything, returns 0 or the first keyframe the engine disagrees with
+int replay_verify(const struct replay_t *, struct tetris_scene_t *);
+
+// Key and placement records in file order, cursor starts at 0. NULL at the end
+const struct replay_event_t * replay_next(const struct replay_t *, size_t *);
+
+// Versus match, attack table NULL for default. Both first pieces spawned
+void versus_init(struct versus_t *, const struct game_config_t *, const int *);
+
+// One piece each, NULL for a player without move. Returns winner, VERSUS_DRAW or VERSUS_RUNNING
+int versus_step(struct versus_t *, const struct placement_t *, const struct placement_t *);
+
+// Whole match between built-in bots, drawn after max turns
+int versus_play(struct versus_t *, const struct eval_weights_t *, const struct eval_weights_t *, int);
+
+// Many games in one file, column per field, optionally compressed
+struct corpus_writer_t;
+
+// Flags CORPUS_ZLIB, NULL on failure
+struct corpus_writer_t * corpus_create(const char *, int);
+int corpus_add(struct corpus_writer_t *, const struct corpus_game_t *);
+int corpus_finish(struct corpus_writer_t *);
+
+// Corpus reader, one decoded block cached. board_init first
+struct corpus_t;
+
+struct corpus_t * corpus_open(const char *);
+void corpus_close(struct corpus_t *);
+int corpus_games(const struct corpus_t *);
+
+// Game i, decodes the block holding it. Events are valid until the next call
+int corpus_get(struct corpus_t *, int, struct corpus_game_t *);
+
+// Scene at the end of a game, simulated from its config and events
+void corpus_play(const struct corpus_game_t *, struct tetris_scene_t *);
+
+// Mirror scene into POSIX shared memory for local readers, see tetris_shm.h
+int shm_export_open(const char *);
+void shm_export_publish(const struct tetris_scene_t *);
+void shm_export_close();
+
+// Play with an external bot over a line protocol, commands from fd, state to stream
+int botpipe_run(struct tetris_scene_t *, int, FILE *);
+
+// Monotonic clock in nanoseconds
+uint64_t perf_now();
+
+// Account one timer tick / rendered frame by its duration
+void perf_tick(uint64_t);
+void perf_frame(uint64_t);
+
+// Figures of the last full second
+const struct perf_report_t * perf_report();
+
+// Chrome trace timeline, spans kept in memory and written by trace_close
+int trace_open(const char *);
+void trace_thread(const char *);
+int trace_close();
+
+// Clock to pass to trace_span, 0 while not tracing
+uint64_t trace_clock();
+void trace_span(const char *, uint64_t);
+
+// Binary event log, one ring per thread drained to the file by a flusher thread
+extern bool evlog_on;
+int evlog_open(const char *);
+void evlog_write(enum evlog_type_e, uint16_t, uint32_t);
+int evlog_close();
+const char * evlog_name(int);
+
+// Append only when a log is open, the check stays inline
+#define EVLOG(type, a, b)               do { if (evlog_on) evlog_write(type, a, b); } while (0)
+
+// Pick best placement for falling block by weighted heuristics, -1 if none
+int bot_choose(struct tetris_scene_t *, const struct eval_weights_t *, struct placement_t *);
+
+// Generate all distinct final positions reachable from spawn
+int movegen_placements(const struct tetris_board_t *, int, struct placement_t *);
+
+// Placement reachable from spawn, same cells as a generated one is enough
+bool movegen_legal(const struct tetris_board_t *, const struct placement_t *);
+
+// Count placements reachable N blocks deep
+unsigned long long int perft(const struct tetris_board_t *, const int *, int, unsigned long long int *);
 
 /*
  * Local variables:
@@ -0,0 +1,106 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file tetris_bot.h
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ *
+ * Plugin ABI of in process bots, loaded by `tetris --bot=lib.so`.
+ * Standalone, a plugin only needs this header.
+ *
+ * A plugin exports :
+ *     int  tetris_bot_choose(void *state, const struct tetris_bot_view_t *view, struct tetris_bot_move_t *move);
+ * and optionally :
+ *     int  tetris_bot_init(const char *args, void **state);
+ *     void tetris_bot_free(void *state);
+ *     uint32_t tetris_bot_abi(void);
+ *
+ * tetris_bot_choose is called once per block right after it spawns, returns 0 with
+ * the final position in move, anything else leaves the block to gravity.
+ * All pointers in view refer to engine memory, read only and valid during the call.
+ */
+
+#ifndef TETRIS_BOT_H
+#define TETRIS_BOT_H
+
+#include <stdint.h>
+
+#define TETRIS_BOT_ABI                  1
+
+// Engine state at spawn, nothing is copied
+struct tetris_bot_view_t
+{
+    uint32_t            abi;
+    int32_t             width;
+    int32_t             height;
+
+    // Board rows from bottom, bit x is column x
+    const uint16_t     *rows;
+
+    // Row masks of block maps [type][dir][row], bit x is column x, same frame as move
+    const uint16_t    (*block_rows)[4][4];
+
+    // Falling block and spawn position, types 1 - 7 : L S J I Z O T
+    int32_t             type;
+    int32_t             spawn_x;
+    int32_t             spawn_y;
+
+    // Upcoming types, ring of queue_size entries starting at queue[queue_head % queue_size]
+    const unsigned char
+                       *queue;
+    uint32_t            queue_head;
+    uint32_t            queue_len;
+    uint32_t            queue_size;
+
+    int32_t             score;
+    int32_t             lines;
+    int32_t             blocks;
+
+    // Answers taking longer are dropped, 0 means no limit
+    uint64_t            budget_ns;
+};
+
+// Final position of block map, must be reachable from spawn
+struct tetris_bot_move_t
+{
+    int32_t             x;
+    int32_t             y;
+    int32_t             dir;
+};
+
+typedef int (*tetris_bot_init_f)(const char *, void **);
+typedef int (*tetris_bot_choose_f)(void *, const struct tetris_bot_view_t *, struct tetris_bot_move_t *);
+typedef void (*tetris_bot_free_f)(void *);
+typedef uint32_t (*tetris_bot_abi_f)(void);
+
+#endif
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
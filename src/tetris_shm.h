@@ -0,0 +1,99 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file tetris_shm.h
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ *
+ * Layout of the live state segment written by `tetris --shm <name>`.
+ * Standalone, readers map /dev/shm/<name> read only and call tetris_shm_read.
+ * The game never waits for readers : seq is odd while a write is in progress,
+ * a copy is consistent if seq was even and unchanged around it.
+ */
+
+#ifndef TETRIS_SHM_H
+#define TETRIS_SHM_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define TETRIS_SHM_MAGIC                0x31544554
+#define TETRIS_SHM_VERSION              1
+#define TETRIS_SHM_ROWS                 32
+
+struct tetris_shm_t
+{
+    uint32_t            magic;
+    uint32_t            version;
+    uint32_t            seq;
+    uint32_t            pid;
+
+    // Board rows from bottom, bit x is column x
+    int32_t             width;
+    int32_t             height;
+    uint16_t            rows[TETRIS_SHM_ROWS];
+
+    // Falling block, type 0 if none. Types 1 - 7 : L S J I Z O T
+    int32_t             type;
+    int32_t             dir;
+    int32_t             x;
+    int32_t             y;
+
+    int32_t             score;
+    int32_t             level;
+    int32_t             blocks;
+    int32_t             lines;
+
+    // 0 prepare, 1 playing, 2 over, 3 egg
+    int32_t             status;
+    uint32_t            updates;
+    uint64_t            tick;
+};
+
+// Consistent copy of segment, spins only while the game is in the middle of a write
+static inline void tetris_shm_read(const struct tetris_shm_t *shm, struct tetris_shm_t *out)
+{
+    uint32_t begin, end;
+
+    do
+    {
+        begin = __atomic_load_n(&shm->seq, __ATOMIC_ACQUIRE);
+        memcpy(out, (const void *)shm, sizeof(struct tetris_shm_t));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        end = __atomic_load_n(&shm->seq, __ATOMIC_RELAXED);
+    } while ((begin & 1) || begin != end);
+
+    return;
+}
+
+#endif
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
@@ -0,0 +1,174 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file trace.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ *
+ * Span timeline in Chrome Trace Event format. Spans go into a ring
+ * allocated up front, recording is a clock read and a slot claim, the
+ * file is only written at the end. A full ring keeps the latest spans.
+ */
+
+#include "tetris.h"
+
+struct trace_span_t
+{
+    const char         *name;
+    uint64_t            begin;
+    uint32_t            dur;
+    uint32_t            tid;
+};
+
+static struct
+{
+    struct trace_span_t
+                       *ring;
+    FILE               *fp;
+    uint64_t            origin;
+    unsigned long long int
+                        count;
+    uint32_t            threads;
+    const char         *names[TRACE_THREADS];
+} trace_state;
+
+static __thread uint32_t trace_tid = 0;
+
+static uint32_t _trace_tid()
+{
+    if (0 == trace_tid)
+    {
+        trace_tid = __atomic_add_fetch(&trace_state.threads, 1, __ATOMIC_RELAXED);
+    }
+
+    return trace_tid;
+}
+
+int trace_open(const char *path)
+{
+    trace_state.fp = fopen(path, "w");
+    if (trace_state.fp == NULL)
+    {
+        return -1;
+    }
+
+    trace_state.ring = calloc(TRACE_RING, sizeof(struct trace_span_t));
+    if (trace_state.ring == NULL)
+    {
+        fclose(trace_state.fp);
+        trace_state.fp = NULL;
+
+        return -1;
+    }
+
+    trace_state.origin = perf_now();
+
+    return 0;
+}
+
+// Name the calling thread in the trace
+void trace_thread(const char *name)
+{
+    uint32_t tid = _trace_tid();
+    if (tid < TRACE_THREADS)
+    {
+        trace_state.names[tid] = name;
+    }
+
+    return;
+}
+
+uint64_t trace_clock()
+{
+    return (trace_state.ring != NULL) ? perf_now() : 0;
+}
+
+// Span from a trace_clock() reading to now, both threads may record at once
+void trace_span(const char *name, uint64_t begin)
+{
+    if (trace_state.ring == NULL || 0 == begin)
+    {
+        return;
+    }
+
+    uint64_t now = perf_now();
+    unsigned long long int n = __atomic_fetch_add(&trace_state.count, 1, __ATOMIC_RELAXED);
+    struct trace_span_t *e = &trace_state.ring[n & (TRACE_RING - 1)];
+    e->name = name;
+    e->begin = begin;
+    e->dur = (now - begin > 0xFFFFFFFF) ? 0xFFFFFFFF : now - begin;
+    e->tid = _trace_tid();
+
+    return;
+}
+
+// Recording threads must have stopped
+int trace_close()
+{
+    if (trace_state.fp == NULL)
+    {
+        return 0;
+    }
+
+    unsigned long long int n = (trace_state.count < TRACE_RING) ? trace_state.count : TRACE_RING;
+    unsigned long long int i;
+    uint32_t t;
+    fprintf(trace_state.fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(trace_state.fp, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"%s\"}}", APP_NAME);
+    for (t = 1; t <= trace_state.threads && t < TRACE_THREADS; t ++)
+    {
+        if (trace_state.names[t] != NULL)
+        {
+            fprintf(trace_state.fp, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}", t, trace_state.names[t]);
+        }
+    }
+
+    for (i = trace_state.count - n; i < trace_state.count; i ++)
+    {
+        const struct trace_span_t *e = &trace_state.ring[i & (TRACE_RING - 1)];
+        fprintf(trace_state.fp,
+                ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                e->name,
+                e->tid,
+                (e->begin - trace_state.origin) / 1e3,
+                e->dur / 1e3);
+    }
+
+    fprintf(trace_state.fp, "\n]}\n");
+    free(trace_state.ring);
+    trace_state.ring = NULL;
+    int ret = fclose(trace_state.fp);
+    trace_state.fp = NULL;
+
+    return ret;
+}
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
@@ -0,0 +1,197 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file vecenv.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ */
+
+#include "tetris.h"
+
+struct vecenv_t
+{
+    int                 n;
+    uint64_t            next_seed;
+    struct game_config_t
+                        config;
+    struct tetris_scene_t
+                        games[];
+};
+
+// New game in slot, seeds run consecutively so a batch is reproducible from one seed
+static void _vecenv_reset(struct vecenv_t *v, int i)
+{
+    struct tetris_scene_t *s = &v->games[i];
+
+    v->config.seed = v->next_seed ++;
+    game_init(s, &v->config);
+    s->egg = 0;
+    game_spawn(s);
+    queue_fill(&s->queue, s->config.randomizer, &s->rng, s->config.preview);
+
+    return;
+}
+
+// Action fits at spawn height
+static inline bool _vecenv_legal(const struct tetris_scene_t *s, int action)
+{
+    return action >= 0 && action < VECENV_ACTIONS &&
+        !board_collide(&s->board, s->curr.type, action / VECENV_COLUMNS, action % VECENV_COLUMNS - 3, s->curr.pos.y);
+}
+
+// Straight drop of action from spawn height, FALSE if blocked there
+static inline bool _vecenv_action(const struct tetris_scene_t *s, int action, struct placement_t *p)
+{
+    if (!_vecenv_legal(s, action))
+    {
+        return FALSE;
+    }
+
+    p->type = s->curr.type;
+    p->dir = action / VECENV_COLUMNS;
+    p->x = action % VECENV_COLUMNS - 3;
+    p->y = s->curr.pos.y - board_drop_distance(&s->board, p->type, p->dir, p->x, s->curr.pos.y);
+
+    return TRUE;
+}
+
+static void _vecenv_observe(const struct vecenv_t *v, int i, const struct vecenv_obs_t *o)
+{
+    const struct tetris_scene_t *s = &v->games[i];
+    int k, type;
+
+    memcpy(o->rows + i * PLAYGROUND_HEIGHT, s->board.rows, sizeof(uint16_t) * PLAYGROUND_HEIGHT);
+    o->piece[i] = s->curr.type;
+    for (k = 0; k < v->config.preview; k ++)
+    {
+        type = queue_peek(&s->queue, k, NULL);
+        o->queue[i * v->config.preview + k] = (type == BLOCK_UNKNOWN) ? 0 : type;
+    }
+
+    if (o->mask != NULL)
+    {
+        for (k = 0; k < VECENV_ACTIONS; k ++)
+        {
+            o->mask[i * VECENV_ACTIONS + k] = _vecenv_legal(s, k);
+        }
+    }
+
+    return;
+}
+
+struct vecenv_t * vecenv_create(int n, const struct game_config_t *config)
+{
+    struct vecenv_t *v;
+    int i;
+
+    if (n < 1 || NULL == (v = malloc(sizeof(struct vecenv_t) + sizeof(struct tetris_scene_t) * n)))
+    {
+        return NULL;
+    }
+
+    board_init();
+    v->n = n;
+    memcpy(&v->config, config, sizeof(struct game_config_t));
+    v->next_seed = config->seed ? config->seed : ((uint64_t)get_random() << 32 | get_random());
+    memset(v->games, 0, sizeof(struct tetris_scene_t) * n);
+    for (i = 0; i < n; i ++)
+    {
+        _vecenv_reset(v, i);
+    }
+
+    return v;
+}
+
+void vecenv_destroy(struct vecenv_t *v)
+{
+    free(v);
+
+    return;
+}
+
+int vecenv_size(const struct vecenv_t *v)
+{
+    return v->n;
+}
+
+void vecenv_observe(struct vecenv_t *v, const struct vecenv_obs_t *o)
+{
+    int i;
+    for (i = 0; i < v->n; i ++)
+    {
+        _vecenv_observe(v, i, o);
+        o->reward[i] = 0;
+        o->done[i] = 0;
+    }
+
+    return;
+}
+
+// One block per game. Blocked actions drop the block where it spawned, finished games restart
+void vecenv_step(struct vecenv_t *v, const int *actions, const struct vecenv_obs_t *o)
+{
+    struct placement_t p;
+    int i, score, ev;
+
+    for (i = 0; i < v->n; i ++)
+    {
+        struct tetris_scene_t *s = &v->games[i];
+        if (!_vecenv_action(s, actions[i], &p))
+        {
+            p.type = s->curr.type;
+            p.dir = s->curr.direction;
+            p.x = s->curr.pos.x;
+            p.y = s->curr.pos.y - board_drop_distance(&s->board, p.type, p.dir, p.x, s->curr.pos.y);
+        }
+
+        // Reward is the line clear award of _check_score, the +1 of the next spawn comes after it
+        score = s->score;
+        ev = game_place(s, &p);
+        o->reward[i] = s->score - score;
+        if (0 == (ev & EVENT_END))
+        {
+            game_spawn(s);
+            queue_fill(&s->queue, s->config.randomizer, &s->rng, s->config.preview);
+        }
+
+        o->done[i] = (STATUS_PLAYING != s->status);
+        if (o->done[i])
+        {
+            _vecenv_reset(v, i);
+        }
+
+        _vecenv_observe(v, i, o);
+    }
+
+    return;
+}
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
@@ -0,0 +1,167 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file versus.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ */
+
+#include "tetris.h"
+
+/*
+ * Lockstep versus : both games start from the same config and so draw the
+ * same pieces. Each turn both place one piece, then lines cleared by a lock
+ * first cancel rows waiting for the clearer and the rest go to the other
+ * side. Rows waiting for a player land under its board when it locks
+ * without clearing. A player loses when garbage pushes blocks over the top,
+ * a lock tops out, or its next piece can not spawn.
+ */
+static const int versus_default_attack[5] = {0, 0, 1, 2, 4};
+
+// Next piece fits at spawn
+static bool _versus_spawn(struct tetris_scene_t *s)
+{
+    game_spawn(s);
+
+    return STATUS_PLAYING == s->status &&
+        !board_collide(&s->board, s->curr.type, s->curr.direction, s->curr.pos.x, s->curr.pos.y);
+}
+
+void versus_init(struct versus_t *v, const struct game_config_t *config, const int *attack)
+{
+    int i;
+
+    memcpy(v->attack, attack ? attack : versus_default_attack, sizeof(v->attack));
+    v->turns = 0;
+    v->winner = VERSUS_RUNNING;
+    for (i = 0; i < 2; i ++)
+    {
+        game_init(&v->games[i], config);
+        v->games[i].egg = 0;
+        v->pending[i] = 0;
+        v->sent[i] = 0;
+        v->rng[i] = config->seed ^ 0x9e3779b97f4a7c15ULL;
+        game_spawn(&v->games[i]);
+    }
+
+    return;
+}
+
+int versus_step(struct versus_t *v, const struct placement_t *p0, const struct placement_t *p1)
+{
+    const struct placement_t *moves[2] = {p0, p1};
+    int cleared[2] = {0, 0};
+    bool lost[2] = {FALSE, FALSE};
+    int i;
+
+    if (VERSUS_RUNNING != v->winner)
+    {
+        return v->winner;
+    }
+
+    for (i = 0; i < 2; i ++)
+    {
+        struct tetris_scene_t *s = &v->games[i];
+        int lines = s->lines;
+        if (moves[i] == NULL || (game_place(s, moves[i]) & EVENT_END))
+        {
+            lost[i] = TRUE;
+
+            continue;
+        }
+
+        cleared[i] = (s->lines - lines > 4) ? 4 : s->lines - lines;
+    }
+
+    // Attacks cross after both locked, so the order players move in does not matter
+    for (i = 0; i < 2; i ++)
+    {
+        int rows = v->attack[cleared[i]];
+        int cancel = (rows < v->pending[i]) ? rows : v->pending[i];
+        v->pending[i] -= cancel;
+        v->pending[1 - i] += rows - cancel;
+        v->sent[i] += rows;
+    }
+
+    for (i = 0; i < 2; i ++)
+    {
+        struct tetris_scene_t *s = &v->games[i];
+        if (lost[i])
+        {
+            continue;
+        }
+
+        if (0 == cleared[i] && v->pending[i] > 0)
+        {
+            // One hole stream per side from the same seed, n-th landing has the same hole on both
+            int hole = rng_next(&v->rng[i]) % PLAYGROUND_WIDTH;
+            lost[i] = board_garbage(&s->board, v->pending[i], hole);
+            v->pending[i] = 0;
+        }
+
+        if (!lost[i] && !_versus_spawn(s))
+        {
+            lost[i] = TRUE;
+        }
+    }
+
+    v->turns ++;
+    if (lost[0] || lost[1])
+    {
+        v->winner = (lost[0] && lost[1]) ? VERSUS_DRAW : (lost[0] ? 1 : 0);
+    }
+
+    return v->winner;
+}
+
+int versus_play(struct versus_t *v, const struct eval_weights_t *w0, const struct eval_weights_t *w1, int max_turns)
+{
+    struct placement_t p[2];
+
+    while (VERSUS_RUNNING == v->winner)
+    {
+        if (v->turns >= max_turns)
+        {
+            v->winner = VERSUS_DRAW;
+
+            break;
+        }
+
+        bool ok0 = bot_choose(&v->games[0], w0, &p[0]) >= 0;
+        bool ok1 = bot_choose(&v->games[1], w1, &p[1]) >= 0;
+        versus_step(v, ok0 ? &p[0] : NULL, ok1 ? &p[1] : NULL);
+    }
+
+    return v->winner;
+}
+
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
@@ -0,0 +1,348 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file corpus.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ */
+
+#include <dirent.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include "../src/tetris.h"
+
+/*
+ * Packs a directory of replays into one corpus, and reads corpora back :
+ * a summary, one game by number, or every game re-simulated and checked
+ * against its recorded outcome.
+ */
+static void _usage()
+{
+    printf("Usage : tetris-corpus -o <corpus> [-z] <replay dir>\n");
+    printf("        tetris-corpus [-g <n>] [-v] <corpus>\n");
+    printf("\t-o <file> : Pack replays of directory into corpus\n");
+    printf("\t-z : Compress columns with zlib\n");
+    printf("\t-g <n> : Show game n\n");
+    printf("\t-v : Re-simulate every game and check its outcome\n");
+    printf("\t-h : Show this help\n\n");
+
+    return;
+}
+
+static int _compare(const void *a, const void *b)
+{
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+static double _elapsed(const struct timespec *begin)
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return (end.tv_sec - begin->tv_sec) + (end.tv_nsec - begin->tv_nsec) / 1e9;
+}
+
+// Only games started from a plain config fit a corpus
+static bool _plain_start(const struct tetris_scene_t *s)
+{
+    static struct tetris_scene_t t;
+
+    game_init(&t, &s->config);
+    t.gravity = s->gravity;
+    t.egg = s->egg;
+
+    return t.status == s->status && t.score == s->score && t.blocks == s->blocks && t.level == s->level &&
+           t.timer_counter == s->timer_counter && t.rng == s->rng && t.replay_hash == s->replay_hash &&
+           0 == memcmp(&t.board, &s->board, sizeof(t.board)) &&
+           0 == memcmp(&t.queue, &s->queue, sizeof(t.queue)) &&
+           t.curr.type == s->curr.type;
+}
+
+static int _pack(const char *dir, const char *path, int flags)
+{
+    static struct tetris_scene_t s;
+    struct replay_event_t *events = NULL;
+    const struct replay_event_t *e;
+    struct corpus_writer_t *w;
+    struct corpus_game_t g;
+    struct dirent *ent;
+    struct timespec begin;
+    struct stat st;
+    char **files = NULL, name[4096];
+    int total = 0, capacity = 0, packed = 0, i;
+    uint32_t events_cap = 0;
+    unsigned long long int input = 0;
+    DIR *d;
+
+    if (NULL == (d = opendir(dir)))
+    {
+        perror(dir);
+
+        return -1;
+    }
+
+    while (NULL != (ent = readdir(d)))
+    {
+        if ('.' == ent->d_name[0])
+        {
+            continue;
+        }
+
+        if (total == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 1024;
+            if (NULL == (files = realloc(files, sizeof(char *) * capacity)))
+            {
+                perror("realloc");
+                exit(-1);
+            }
+        }
+
+        files[total ++] = strdup(ent->d_name);
+    }
+
+    closedir(d);
+
+    // Stable game numbers whatever order the directory lists in
+    qsort(files, total, sizeof(char *), _compare);
+    if (NULL == (w = corpus_create(path, flags)))
+    {
+        perror(path);
+
+        return -1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (i = 0; i < total; i ++)
+    {
+        snprintf(name, sizeof(name), "%s/%s", dir, files[i]);
+        struct replay_t *r = replay_open(name);
+        if (r == NULL)
+        {
+            printf("SKIP %s : unreadable\n", name);
+
+            continue;
+        }
+
+        replay_seek(r, 0, &s);
+        if (!_plain_start(&s))
+        {
+            printf("SKIP %s : does not start from a plain config\n", name);
+            replay_close(r);
+
+            continue;
+        }
+
+        memset(&g, 0, sizeof(g));
+        g.config = s.config;
+        g.gravity = s.gravity;
+        g.egg = s.egg;
+        size_t cursor = 0;
+        while (NULL != (e = replay_next(r, &cursor)))
+        {
+            if (g.events_count == events_cap)
+            {
+                events_cap = events_cap ? events_cap * 2 : 4096;
+                if (NULL == (events = realloc(events, sizeof(struct replay_event_t) * events_cap)))
+                {
+                    perror("realloc");
+                    exit(-1);
+                }
+            }
+
+            events[g.events_count ++] = *e;
+        }
+
+        g.events = events;
+        replay_seek(r, INT_MAX, &s);
+        g.status = s.status;
+        g.score = s.score;
+        g.blocks = s.blocks;
+        g.lines = s.lines;
+        g.end_tick = s.timer_counter;
+        g.replay_hash = s.replay_hash;
+        replay_close(r);
+        if (0 != corpus_add(w, &g))
+        {
+            perror("corpus_add");
+            exit(-1);
+        }
+
+        if (0 == stat(name, &st))
+        {
+            input += st.st_size;
+        }
+
+        packed ++;
+    }
+
+    if (0 != corpus_finish(w))
+    {
+        perror("corpus_finish");
+        exit(-1);
+    }
+
+    double elapsed = _elapsed(&begin);
+    stat(path, &st);
+    printf("%d of %d replays packed in %.2fs, %llu bytes into %lld (%.1f%%), %.0f bytes per game\n",
+           packed, total, elapsed, input, (long long int)st.st_size,
+           input ? 100.0 * st.st_size / input : 0.0, packed ? (double)st.st_size / packed : 0.0);
+    for (i = 0; i < total; i ++)
+    {
+        free(files[i]);
+    }
+
+    free(files);
+    free(events);
+
+    return 0;
+}
+
+static void _show(const struct corpus_game_t *g, int i)
+{
+    printf("Game %d : seed %llu, level %d, preview %d, randomizer %d, gravity %u\n",
+           i, (unsigned long long int)g->config.seed, g->config.level, g->config.preview,
+           g->config.randomizer, g->gravity);
+    printf("\t%u events, %d pieces, %d lines, score %d in %llu ticks, checksum %08x\n",
+           g->events_count, g->blocks, g->lines, g->score, (unsigned long long int)g->end_tick, g->replay_hash);
+
+    return;
+}
+
+int main(int argc, char *argv[])
+{
+    static struct tetris_scene_t s;
+    struct corpus_game_t g;
+    struct corpus_t *corpus;
+    struct timespec begin;
+    const char *output = NULL;
+    int flags = 0, game = -1, c, i;
+    bool verify = FALSE;
+    int failed = 0;
+    unsigned long long int blocks = 0, events = 0;
+
+    while (-1 != (c = getopt(argc, argv, "o:zg:vh")))
+    {
+        switch (c)
+        {
+            case 'o' :
+                output = optarg;
+                break;
+            case 'z' :
+                flags |= CORPUS_ZLIB;
+                break;
+            case 'g' :
+                game = atoi(optarg);
+                break;
+            case 'v' :
+                verify = TRUE;
+                break;
+            case 'h' :
+            default :
+                _usage();
+                exit(('h' == c) ? 0 : -1);
+                break;
+        }
+    }
+
+    if (optind >= argc)
+    {
+        _usage();
+        exit(-1);
+    }
+
+    board_init();
+    if (output != NULL)
+    {
+        return (0 == _pack(argv[optind], output, flags)) ? 0 : 1;
+    }
+
+    if (NULL == (corpus = corpus_open(argv[optind])))
+    {
+        printf("Can not read corpus <%s>\n", argv[optind]);
+        exit(-1);
+    }
+
+    if (game >= 0)
+    {
+        if (0 != corpus_get(corpus, game, &g))
+        {
+            printf("No game %d\n", game);
+            exit(-1);
+        }
+
+        _show(&g, game);
+        corpus_close(corpus);
+
+        return 0;
+    }
+
+    // Streaming pass, one decoded block in memory at a time
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (i = 0; i < corpus_games(corpus); i ++)
+    {
+        if (0 != corpus_get(corpus, i, &g))
+        {
+            printf("Corrupt block at game %d\n", i);
+            failed ++;
+
+            break;
+        }
+
+        blocks += g.blocks;
+        events += g.events_count;
+        if (verify)
+        {
+            corpus_play(&g, &s);
+            if (s.score != g.score || s.blocks != g.blocks || s.lines != g.lines ||
+                s.timer_counter != g.end_tick || s.replay_hash != g.replay_hash)
+            {
+                printf("MISMATCH game %d : piece %d, score %d, recorded %d / %d\n", i, s.blocks, s.score, g.blocks, g.score);
+                failed ++;
+            }
+        }
+    }
+
+    double elapsed = _elapsed(&begin);
+    printf("%d games, %llu pieces, %llu events", corpus_games(corpus), blocks, events);
+    if (verify)
+    {
+        printf(", %d mismatched, %.2fs : %.0f games/s, %.0f pieces/s", failed, elapsed, corpus_games(corpus) / elapsed, blocks / elapsed);
+    }
+
+    printf("\n");
+    corpus_close(corpus);
+
+    return failed ? 1 : 0;
+}
+
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
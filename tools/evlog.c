@@ -0,0 +1,187 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file evlog.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ */
+
+#include "../src/tetris.h"
+
+/*
+ * Prints a binary event log written by `tetris --log`, one record per
+ * line. Records reach the file in flusher batches, per thread in order
+ * but threads interleaved by batch; -s merges them by time.
+ */
+static void _usage()
+{
+    printf("Usage : tetris-evlog [options] <file>\n");
+    printf("\t-s : Sort records of all threads by time\n");
+    printf("\t-h : Show this help\n\n");
+
+    return;
+}
+
+static int _cmp(const void *a, const void *b)
+{
+    uint64_t x = ((const struct evlog_record_t *)a)->ns;
+    uint64_t y = ((const struct evlog_record_t *)b)->ns;
+
+    return (x > y) - (x < y);
+}
+
+static void _print(const struct evlog_header_t *h, const struct evlog_record_t *e)
+{
+    printf("%14.6f ms  T%-2u %-8s", (e->ns - h->origin_ns) / 1e6, e->thread, evlog_name(e->type));
+    switch (e->type)
+    {
+        case EVLOG_TICK:
+            printf("events %#x, %u ns\n", e->a, e->b);
+            break;
+        case EVLOG_SPAWN:
+            printf("type %u, block %u\n", e->a, e->b);
+            break;
+        case EVLOG_KEY:
+            printf("key %u %s, tick %u\n", e->a & 0xFF, (e->a >> 8) ? "accepted" : "rejected", e->b);
+            break;
+        case EVLOG_LOCK:
+            printf("type %u at <%d : %d> direction %u\n", e->a, (int8_t)(e->b >> 8), (int8_t)e->b, e->b >> 16);
+            break;
+        case EVLOG_CLEAR:
+            printf("%u lines, score %u\n", e->a, e->b);
+            break;
+        case EVLOG_END:
+            printf("status %u, score %u\n", e->a, e->b);
+            break;
+        case EVLOG_FRAME:
+            printf("%u ns\n", e->b);
+            break;
+        case EVLOG_DROPPED:
+            printf("%u records lost\n", e->b);
+            break;
+        default:
+            printf("%u %u\n", e->a, e->b);
+            break;
+    }
+
+    return;
+}
+
+int main(int argc, char *argv[])
+{
+    struct evlog_header_t h;
+    struct evlog_record_t *list = NULL, e;
+    size_t n = 0, capacity = 0, i;
+    bool sort = FALSE;
+    int c;
+
+    while (-1 != (c = getopt(argc, argv, "sh")))
+    {
+        switch (c)
+        {
+            case 's' :
+                sort = TRUE;
+                break;
+            case 'h' :
+            default :
+                _usage();
+                exit(('h' == c) ? 0 : -1);
+                break;
+        }
+    }
+
+    if (optind >= argc)
+    {
+        _usage();
+        exit(-1);
+    }
+
+    FILE *fp = fopen(argv[optind], "rb");
+    if (fp == NULL)
+    {
+        perror("fopen");
+        exit(-1);
+    }
+
+    if (1 != fread(&h, sizeof(h), 1, fp) || 0 != memcmp(h.magic, EVLOG_MAGIC, 8) ||
+        EVLOG_VERSION != h.version || sizeof(struct evlog_record_t) != h.record_size)
+    {
+        printf("Not an event log <%s>\n", argv[optind]);
+        fclose(fp);
+        exit(-1);
+    }
+
+    time_t wall = h.wall_s;
+    printf("Event log of %s", ctime(&wall));
+    while (1 == fread(&e, sizeof(e), 1, fp))
+    {
+        if (!sort)
+        {
+            _print(&h, &e);
+            n ++;
+
+            continue;
+        }
+
+        if (n == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 4096;
+            struct evlog_record_t *grown = realloc(list, capacity * sizeof(e));
+            if (grown == NULL)
+            {
+                perror("realloc");
+                exit(-1);
+            }
+
+            list = grown;
+        }
+
+        list[n ++] = e;
+    }
+
+    fclose(fp);
+    if (sort)
+    {
+        qsort(list, n, sizeof(e), _cmp);
+        for (i = 0; i < n; i ++)
+        {
+            _print(&h, &list[i]);
+        }
+
+        free(list);
+    }
+
+    printf("%zu records\n", n);
+
+    return 0;
+}
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
@@ -0,0 +1,166 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file shm.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ *
+ * Sample reader of `tetris --shm`, only depends on tetris_shm.h
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include "../src/tetris_shm.h"
+
+static const char *shm_types = "-LSJIZOT";
+
+static void _usage()
+{
+    printf("tetris-shm - attach to live game state\n\n");
+    printf("Usage : tetris-shm [-f] [-i ms] <name>\n");
+    printf("\t-f : Follow, print every update\n");
+    printf("\t-i <ms> : Poll interval in follow mode, default <10>\n");
+    printf("\t-h : Print this topic\n");
+
+    return;
+}
+
+static void _print(const struct tetris_shm_t *st, int board)
+{
+    int i, j;
+
+    printf("#%u tick %llu status %d score %d level %d blocks %d lines %d block %c <%d, %d> dir %d\n",
+        st->updates, (unsigned long long)st->tick, st->status, st->score, st->level, st->blocks, st->lines,
+        shm_types[(st->type >= 0 && st->type < 8) ? st->type : 0], st->x, st->y, st->dir);
+    if (!board)
+    {
+        return;
+    }
+
+    for (i = st->height - 1; i >= 0; i --)
+    {
+        for (j = 0; j < st->width; j ++)
+        {
+            putchar(((st->rows[i] >> j) & 1) ? '#' : '.');
+        }
+
+        putchar('\n');
+    }
+
+    return;
+}
+
+int main(int argc, char *argv[])
+{
+    struct tetris_shm_t st;
+    struct timespec ts;
+    const struct tetris_shm_t *shm;
+    char path[256];
+    int c, fd, follow = 0, interval = 10;
+    uint32_t seen = 0;
+
+    while (-1 != (c = getopt(argc, argv, "fi:h")))
+    {
+        switch (c)
+        {
+            case 'f' :
+                follow = 1;
+                break;
+            case 'i' :
+                interval = atoi(optarg);
+                break;
+            case 'h' :
+            default :
+                _usage();
+                exit(('h' == c) ? 0 : -1);
+                break;
+        }
+    }
+
+    if (optind >= argc)
+    {
+        _usage();
+        exit(-1);
+    }
+
+    snprintf(path, sizeof(path), "%s%s", ('/' == argv[optind][0]) ? "" : "/", argv[optind]);
+    fd = shm_open(path, O_RDONLY, 0);
+    if (fd < 0)
+    {
+        perror("shm_open");
+
+        return -1;
+    }
+
+    shm = mmap(NULL, sizeof(struct tetris_shm_t), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED == shm)
+    {
+        perror("mmap");
+
+        return -1;
+    }
+
+    if (TETRIS_SHM_MAGIC != __atomic_load_n(&shm->magic, __ATOMIC_ACQUIRE) || TETRIS_SHM_VERSION != shm->version)
+    {
+        fprintf(stderr, "%s : not a tetris state segment of version %d\n", path, TETRIS_SHM_VERSION);
+
+        return -1;
+    }
+
+    tetris_shm_read(shm, &st);
+    _print(&st, 1);
+    seen = st.updates;
+
+    // Reads are plain loads from the mapping, the sleep only paces polling
+    ts.tv_sec = interval / 1000;
+    ts.tv_nsec = (interval % 1000) * 1000000L;
+    while (follow && st.status < 2)
+    {
+        nanosleep(&ts, NULL);
+        tetris_shm_read(shm, &st);
+        if (st.updates != seen)
+        {
+            _print(&st, 0);
+            seen = st.updates;
+        }
+    }
+
+    munmap((void *)shm, sizeof(struct tetris_shm_t));
+
+    return 0;
+}
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
@@ -0,0 +1,502 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file tournament.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ */
+
+#include <math.h>
+#include <pthread.h>
+#include "../src/tetris.h"
+
+#define TOURNAMENT_MAX_ENTRANTS         64
+#define TOURNAMENT_MAGIC                "# tetris-tournament 1"
+
+/*
+ * Round robin : every pair of entrants plays the same n seeded versus
+ * matches, so pairings differ only by who plays. Matches are numbered
+ * pair * n + k and taken by workers through an atomic cursor. A finished
+ * match is appended to the results file at once, a rerun with the same
+ * entrants and settings skips what the file already holds.
+ *
+ * Ratings are a Bradley-Terry fit, a draw counting half a win for both and
+ * one virtual draw per pairing keeping everything finite, reported on the
+ * Elo scale around 1500 with 95% intervals from the fit's curvature.
+ */
+struct entrant_t
+{
+    const char         *spec;
+    const char         *path;
+    const char         *args;
+    struct eval_weights_t
+                        weights;
+};
+
+struct tournament_t
+{
+    struct entrant_t    entrants[TOURNAMENT_MAX_ENTRANTS];
+    int                 n;
+    int                 pairs[TOURNAMENT_MAX_ENTRANTS * (TOURNAMENT_MAX_ENTRANTS - 1) / 2][2];
+    int                 matches;
+    int                 max_turns;
+    uint64_t            seed;
+    int                 total;
+    int                 next;
+    int                 played;
+    unsigned char      *done;
+
+    // Points of row against column, doubled so draws stay integer
+    int                 points[TOURNAMENT_MAX_ENTRANTS][TOURNAMENT_MAX_ENTRANTS];
+    int                 games[TOURNAMENT_MAX_ENTRANTS][TOURNAMENT_MAX_ENTRANTS];
+    int                 wins[TOURNAMENT_MAX_ENTRANTS];
+    int                 draws[TOURNAMENT_MAX_ENTRANTS];
+    int                 losses[TOURNAMENT_MAX_ENTRANTS];
+    FILE               *results;
+    pthread_mutex_t     lock;
+};
+
+static void _usage()
+{
+    printf("%s tournament - %s\n\n", APP_NAME, APP_VERSION);
+    printf("Round robin of bots, every pairing plays the same seeded versus matches\n\n");
+    printf("Usage : tetris-tournament [options] <entrant> <entrant> ...\n");
+    printf("\tEntrant : <plugin.so>[:args] / builtin / w:<h,holes,bump,lines>\n\n");
+    printf("\t-n <n> : Matches per pairing, default <100>\n");
+    printf("\t-m <n> : Turns before a match is drawn, default <1000>\n");
+    printf("\t-o <file> : Results, appended as matches finish and resumed from, default <tournament.txt>\n");
+    printf("\t-j <n> : Worker threads, default all cores\n");
+    printf("\t-s <seed> : Seed of the first match of every pairing\n");
+    printf("\t-h : Print this topic\n");
+
+    return;
+}
+
+static int _entrant(struct entrant_t *e, char *spec)
+{
+    float v[4];
+    char *p;
+
+    e->spec = strdup(spec);
+    e->weights = bot_default_weights;
+    if (0 == strcmp(spec, "builtin"))
+    {
+        return 0;
+    }
+
+    if (0 == strncmp(spec, "w:", 2))
+    {
+        if (4 != sscanf(spec + 2, "%f,%f,%f,%f", &v[0], &v[1], &v[2], &v[3]))
+        {
+            return -1;
+        }
+
+        e->weights = (struct eval_weights_t){v[0], v[1], v[2], v[3]};
+
+        return 0;
+    }
+
+    if (NULL != (p = strchr(spec, ':')))
+    {
+        *p = 0;
+        e->args = p + 1;
+    }
+
+    e->path = spec;
+
+    return 0;
+}
+
+static void _record(struct tournament_t *t, int match, int winner)
+{
+    int a = t->pairs[match / t->matches][0];
+    int b = t->pairs[match / t->matches][1];
+
+    t->done[match] = 1;
+    t->played ++;
+    t->games[a][b] ++;
+    t->games[b][a] ++;
+    if (VERSUS_DRAW == winner)
+    {
+        t->points[a][b] ++;
+        t->points[b][a] ++;
+        t->draws[a] ++;
+        t->draws[b] ++;
+    }
+    else
+    {
+        int w = winner ? b : a, l = winner ? a : b;
+        t->points[w][l] += 2;
+        t->wins[w] ++;
+        t->losses[l] ++;
+    }
+
+    return;
+}
+
+static void * _worker(void *arg)
+{
+    struct tournament_t *t = arg;
+    struct bot_plugin_t *bots[TOURNAMENT_MAX_ENTRANTS];
+    struct game_config_t config;
+    struct placement_t p[2];
+    struct versus_t v;
+    int match, side;
+
+    // Plugins keep state, every worker owns its instances
+    memset(bots, 0, sizeof(bots));
+    game_config_default(&config);
+    while ((match = __atomic_fetch_add(&t->next, 1, __ATOMIC_RELAXED)) < t->total)
+    {
+        const int *pair = t->pairs[match / t->matches];
+        if (t->done[match])
+        {
+            continue;
+        }
+
+        config.seed = t->seed + match % t->matches;
+        versus_init(&v, &config, NULL);
+        while (VERSUS_RUNNING == v.winner)
+        {
+            if (v.turns >= t->max_turns)
+            {
+                v.winner = VERSUS_DRAW;
+
+                break;
+            }
+
+            bool ok[2];
+            for (side = 0; side < 2; side ++)
+            {
+                const struct entrant_t *e = &t->entrants[pair[side]];
+                if (e->path == NULL)
+                {
+                    ok[side] = bot_choose(&v.games[side], &e->weights, &p[side]) >= 0;
+
+                    continue;
+                }
+
+                if (bots[pair[side]] == NULL && NULL == (bots[pair[side]] = bot_plugin_open(e->path, e->args, 0)))
+                {
+                    exit(-1);
+                }
+
+                ok[side] = 0 == bot_plugin_choose(bots[pair[side]], &v.games[side], &p[side]);
+            }
+
+            versus_step(&v, ok[0] ? &p[0] : NULL, ok[1] ? &p[1] : NULL);
+        }
+
+        pthread_mutex_lock(&t->lock);
+        _record(t, match, v.winner);
+        fprintf(t->results, "%d %d %d %d %d\n", match, pair[0], pair[1], v.winner, v.turns);
+        fflush(t->results);
+        pthread_mutex_unlock(&t->lock);
+    }
+
+    for (side = 0; side < t->n; side ++)
+    {
+        bot_plugin_close(bots[side]);
+    }
+
+    return NULL;
+}
+
+// Header names everything results depend on, a file for another tournament is refused
+static void _header(const struct tournament_t *t, char *buf, size_t size)
+{
+    int i, len = snprintf(buf, size, "%s matches=%d turns=%d seed=%llu\n",
+                          TOURNAMENT_MAGIC, t->matches, t->max_turns, (unsigned long long int)t->seed);
+    for (i = 0; i < t->n && len < size; i ++)
+    {
+        // Spec was copied before args were split off, it already carries them
+        len += snprintf(buf + len, size - len, "# entrant %d %s\n", i, t->entrants[i].spec);
+    }
+
+    return;
+}
+
+// Load finished matches, drop a line cut short by an interruption. -2 if file belongs to another tournament
+static int _resume(struct tournament_t *t, const char *path)
+{
+    static char header[65536], stored[65536], line[4096];
+    size_t len, at = 0, good;
+    int match, a, b, winner, turns;
+    FILE *fp;
+
+    _header(t, header, sizeof(header));
+    if (NULL == (fp = fopen(path, "r+")))
+    {
+        if (NULL == (t->results = fopen(path, "w")))
+        {
+            return -1;
+        }
+
+        fputs(header, t->results);
+        fflush(t->results);
+
+        return 0;
+    }
+
+    len = strlen(header);
+    if (len != fread(stored, 1, len, fp) || 0 != memcmp(stored, header, len))
+    {
+        fclose(fp);
+
+        return -2;
+    }
+
+    good = at = len;
+    while (NULL != fgets(line, sizeof(line), fp))
+    {
+        at += strlen(line);
+        if ('\n' != line[strlen(line) - 1] ||
+            5 != sscanf(line, "%d %d %d %d %d", &match, &a, &b, &winner, &turns) ||
+            match < 0 || match >= t->total || winner < 0 || winner > VERSUS_DRAW)
+        {
+            break;
+        }
+
+        if (!t->done[match])
+        {
+            _record(t, match, winner);
+        }
+
+        good = at;
+    }
+
+    fflush(fp);
+    if (0 != ftruncate(fileno(fp), good) || 0 != fseek(fp, good, SEEK_SET))
+    {
+        fclose(fp);
+
+        return -1;
+    }
+
+    t->results = fp;
+
+    return 0;
+}
+
+static void _ratings(const struct tournament_t *t)
+{
+    double gamma[TOURNAMENT_MAX_ENTRANTS], next[TOURNAMENT_MAX_ENTRANTS], se[TOURNAMENT_MAX_ENTRANTS];
+    int order[TOURNAMENT_MAX_ENTRANTS];
+    int i, j, it;
+
+    // Minorization-maximization on strengths, one virtual draw per pair as prior
+    for (i = 0; i < t->n; i ++)
+    {
+        gamma[i] = 1.0;
+    }
+
+    for (it = 0; it < 2000; it ++)
+    {
+        double norm = 0;
+        for (i = 0; i < t->n; i ++)
+        {
+            double won = 0, denom = 0;
+            for (j = 0; j < t->n; j ++)
+            {
+                if (i != j)
+                {
+                    won += t->points[i][j] / 2.0 + 0.5;
+                    denom += (t->games[i][j] + 1) / (gamma[i] + gamma[j]);
+                }
+            }
+
+            next[i] = won / denom;
+            norm += log(next[i]);
+        }
+
+        norm = exp(norm / t->n);
+        for (i = 0; i < t->n; i ++)
+        {
+            gamma[i] = next[i] / norm;
+        }
+    }
+
+    // Standard error from the information of each strength, others held fixed
+    for (i = 0; i < t->n; i ++)
+    {
+        double info = 0;
+        for (j = 0; j < t->n; j ++)
+        {
+            if (i != j)
+            {
+                double p = gamma[i] / (gamma[i] + gamma[j]);
+                info += (t->games[i][j] + 1) * p * (1 - p);
+            }
+        }
+
+        se[i] = 1.0 / sqrt(info);
+        order[i] = i;
+    }
+
+    for (i = 1; i < t->n; i ++)
+    {
+        for (j = i; j > 0 && gamma[order[j]] > gamma[order[j - 1]]; j --)
+        {
+            int k = order[j];
+            order[j] = order[j - 1];
+            order[j - 1] = k;
+        }
+    }
+
+    double scale = 400.0 / log(10.0);
+    printf("\n%4s  %-40s %6s %6s %7s %7s %7s %7s\n", "Rank", "Entrant", "Elo", "95%", "Win", "Draw", "Loss", "Score");
+    for (i = 0; i < t->n; i ++)
+    {
+        int k = order[i];
+        int games = t->wins[k] + t->draws[k] + t->losses[k];
+        printf("%4d  %-40.40s %6.0f %6.0f %7d %7d %7d %6.1f%%\n", i + 1, t->entrants[k].spec,
+               1500 + scale * log(gamma[k]), 1.96 * scale * se[k], t->wins[k], t->draws[k], t->losses[k],
+               games ? 100.0 * (t->wins[k] + 0.5 * t->draws[k]) / games : 0.0);
+    }
+
+    return;
+}
+
+int main(int argc, char *argv[])
+{
+    static struct tournament_t t;
+    struct timespec begin, end;
+    const char *output = "tournament.txt";
+    int threads = sysconf(_SC_NPROCESSORS_ONLN);
+    int c, i, j, k = 0, resumed;
+
+    t.matches = 100;
+    t.max_turns = 1000;
+    t.seed = 1024;
+    while (-1 != (c = getopt(argc, argv, "n:m:o:j:s:h")))
+    {
+        switch (c)
+        {
+            case 'n' :
+                t.matches = atoi(optarg);
+                break;
+            case 'm' :
+                t.max_turns = atoi(optarg);
+                break;
+            case 'o' :
+                output = optarg;
+                break;
+            case 'j' :
+                threads = atoi(optarg);
+                break;
+            case 's' :
+                t.seed = strtoull(optarg, NULL, 10);
+                break;
+            case 'h' :
+            default :
+                _usage();
+                exit(('h' == c) ? 0 : -1);
+                break;
+        }
+    }
+
+    t.n = argc - optind;
+    if (t.n < 2 || t.n > TOURNAMENT_MAX_ENTRANTS || t.matches < 1 || threads < 1)
+    {
+        _usage();
+        exit(-1);
+    }
+
+    for (i = 0; i < t.n; i ++)
+    {
+        if (0 != _entrant(&t.entrants[i], argv[optind + i]))
+        {
+            printf("Invalid entrant <%s>\n", argv[optind + i]);
+            exit(-1);
+        }
+    }
+
+    for (i = 0; i < t.n; i ++)
+    {
+        for (j = i + 1; j < t.n; j ++, k ++)
+        {
+            t.pairs[k][0] = i;
+            t.pairs[k][1] = j;
+        }
+    }
+
+    t.total = k * t.matches;
+    t.done = calloc(t.total, 1);
+    pthread_t *workers = malloc(sizeof(pthread_t) * threads);
+    if (t.done == NULL || workers == NULL)
+    {
+        perror("malloc");
+        exit(-1);
+    }
+
+    board_init();
+    if (0 != (i = _resume(&t, output)))
+    {
+        if (-2 == i)
+        {
+            printf("<%s> holds results of another tournament\n", output);
+        }
+        else
+        {
+            perror(output);
+        }
+
+        exit(-1);
+    }
+
+    resumed = t.played;
+    printf("%d entrants, %d pairings, %d matches, %d already played\n", t.n, k, t.total, resumed);
+    pthread_mutex_init(&t.lock, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (i = 0; i < threads; i ++)
+    {
+        pthread_create(&workers[i], NULL, _worker, &t);
+    }
+
+    for (i = 0; i < threads; i ++)
+    {
+        pthread_join(workers[i], NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed = (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) / 1e9;
+    printf("%d matches in %.2fs : %.1f matches/s on %d threads\n",
+           t.played - resumed, elapsed, (t.played - resumed) / elapsed, threads);
+    _ratings(&t);
+    fclose(t.results);
+    free(t.done);
+    free(workers);
+
+    return 0;
+}
+
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
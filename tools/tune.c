@@ -0,0 +1,436 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file tune.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ */
+
+#include <math.h>
+#include <pthread.h>
+#include "../src/tetris.h"
+
+#define TUNE_FEATURES                   4
+#define TUNE_MAX_POPULATION             256
+#define TUNE_CHECKPOINT_MAGIC           "tetris-tune 2"
+
+/*
+ * Cross-entropy method : sample a population around the mean, keep the
+ * elite quarter, refit mean / deviation to it. Every candidate plays the
+ * same seeded games (common random numbers) so differences in fitness come
+ * from the weights and not from the block sequence.
+ */
+struct tune_state_t
+{
+    int                 generation;
+    uint64_t            rng;
+
+    // Game sets of the run, kept across resumes
+    uint64_t            seed;
+    int                 population;
+    int                 games;
+    int                 max_blocks;
+    int                 randomizer;
+    float               mean[TUNE_FEATURES];
+    float               sigma[TUNE_FEATURES];
+    float               best[TUNE_FEATURES];
+    double              best_fitness;
+};
+
+struct tune_job_t
+{
+    struct eval_weights_t
+                        candidates[TUNE_MAX_POPULATION];
+    int                 population;
+    int                 games;
+    int                 max_blocks;
+    enum randomizer_e   randomizer;
+    uint64_t            seed;
+    int                 next;
+    int                 *lines;
+};
+
+static struct eval_weights_t _to_weights(const float *v)
+{
+    struct eval_weights_t w = {v[0], v[1], v[2], v[3]};
+
+    return w;
+}
+
+// One headless game, returns lines cleared
+static int _play(const struct eval_weights_t *w, uint64_t seed, const struct tune_job_t *job)
+{
+    struct tetris_scene_t s;
+    struct game_config_t config;
+    struct placement_t p;
+
+    game_config_default(&config);
+    config.seed = seed;
+    config.randomizer = job->randomizer;
+    memset(&s, 0, sizeof(struct tetris_scene_t));
+    game_init(&s, &config);
+    s.egg = 0;
+    while (s.blocks < job->max_blocks)
+    {
+        game_spawn(&s);
+        if (bot_choose(&s, w, &p) < 0)
+        {
+            break;
+        }
+
+        if (game_place(&s, &p) & EVENT_END)
+        {
+            break;
+        }
+    }
+
+    return s.lines;
+}
+
+static void * _worker(void *arg)
+{
+    struct tune_job_t *job = arg;
+    int total = job->population * job->games;
+    int i;
+    while ((i = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED)) < total)
+    {
+        int cand = i / job->games;
+        int game = i % job->games;
+        job->lines[i] = _play(&job->candidates[cand], job->seed + game, job);
+    }
+
+    return NULL;
+}
+
+static double _gaussian(uint64_t *rng)
+{
+    double u1 = (rng_next(rng) + 1.0) / 4294967297.0;
+    double u2 = rng_next(rng) / 4294967296.0;
+
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static int _save(const char *path, const struct tune_state_t *st)
+{
+    static char tmp[4096];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE *fp = fopen(tmp, "w");
+    if (fp == NULL)
+    {
+        return -1;
+    }
+
+    fprintf(fp, "%s\n", TUNE_CHECKPOINT_MAGIC);
+    fprintf(fp, "generation %d\n", st->generation);
+    fprintf(fp, "rng %llu\n", (unsigned long long int)st->rng);
+    fprintf(fp, "seed %llu\n", (unsigned long long int)st->seed);
+    fprintf(fp, "games %d %d %d %d\n", st->population, st->games, st->max_blocks, st->randomizer);
+    fprintf(fp, "mean %.9g %.9g %.9g %.9g\n", st->mean[0], st->mean[1], st->mean[2], st->mean[3]);
+    fprintf(fp, "sigma %.9g %.9g %.9g %.9g\n", st->sigma[0], st->sigma[1], st->sigma[2], st->sigma[3]);
+    fprintf(fp, "best %.9g %.9g %.9g %.9g %.9g\n", st->best_fitness, st->best[0], st->best[1], st->best[2], st->best[3]);
+    if (fflush(fp) != 0 || fsync(fileno(fp)) != 0)
+    {
+        fclose(fp);
+
+        return -1;
+    }
+
+    fclose(fp);
+
+    // Replace atomically, a crash leaves the previous generation intact
+    return rename(tmp, path);
+}
+
+static int _load(const char *path, struct tune_state_t *st)
+{
+    static char magic[64];
+    unsigned long long int rng, seed;
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL)
+    {
+        return -1;
+    }
+
+    int n = 0;
+    if (fgets(magic, sizeof(magic), fp) && 0 == strncmp(magic, TUNE_CHECKPOINT_MAGIC, strlen(TUNE_CHECKPOINT_MAGIC)))
+    {
+        n += fscanf(fp, " generation %d", &st->generation);
+        n += fscanf(fp, " rng %llu", &rng);
+        n += fscanf(fp, " seed %llu", &seed);
+        n += fscanf(fp, " games %d %d %d %d", &st->population, &st->games, &st->max_blocks, &st->randomizer);
+        n += fscanf(fp, " mean %f %f %f %f", &st->mean[0], &st->mean[1], &st->mean[2], &st->mean[3]);
+        n += fscanf(fp, " sigma %f %f %f %f", &st->sigma[0], &st->sigma[1], &st->sigma[2], &st->sigma[3]);
+        n += fscanf(fp, " best %lf %f %f %f %f", &st->best_fitness, &st->best[0], &st->best[1], &st->best[2], &st->best[3]);
+    }
+
+    fclose(fp);
+    st->rng = rng;
+    st->seed = seed;
+
+    return (n == 20 && st->population >= 4 && st->population <= TUNE_MAX_POPULATION && st->games >= 1 &&
+            st->randomizer >= RANDOMIZER_UNIFORM && st->randomizer <= RANDOMIZER_HISTORY) ? 0 : -1;
+}
+
+static int _cmp_fitness(const void *a, const void *b)
+{
+    double fa = ((const double *)a)[0];
+    double fb = ((const double *)b)[0];
+
+    return (fa < fb) - (fa > fb);
+}
+
+static void _usage()
+{
+    printf("%s tune - %s\n\n", APP_NAME, APP_VERSION);
+    printf("Search heuristic weights of the bot with the cross-entropy method\n\n");
+    printf("\t-g <n> : Generations, default <30>\n");
+    printf("\t-p <n> : Population per generation [4 - %d], default <32>\n", TUNE_MAX_POPULATION);
+    printf("\t-n <n> : Seeded games per candidate, default <200>\n");
+    printf("\t-m <n> : Blocks per game at most, default <500>\n");
+    printf("\t-r <uniform|bag|history> : Block generator, default <uniform>\n");
+    printf("\t-j <n> : Worker threads, default all cores\n");
+    printf("\t-s <seed> : Seed of sampling and game sequences\n");
+    printf("\t-c <file> : Checkpoint, resumed when it exists with its own -p -n -m -r -s, default <tetris-tune.ckpt>\n");
+    printf("\t-h : Print this topic\n");
+
+    return;
+}
+
+int main(int argc, char *argv[])
+{
+    static struct tune_job_t job;
+    static double ranked[TUNE_MAX_POPULATION][1 + TUNE_FEATURES];
+    struct tune_state_t st;
+    int generations = 30, threads = sysconf(_SC_NPROCESSORS_ONLN);
+    uint64_t seed = 1024;
+    const char *checkpoint = "tetris-tune.ckpt";
+    int c, i, k;
+
+    job.population = 32;
+    job.games = 200;
+    job.max_blocks = 500;
+    while (-1 != (c = getopt(argc, argv, "g:p:n:m:r:j:s:c:h")))
+    {
+        switch (c)
+        {
+            case 'g' :
+                generations = atoi(optarg);
+                break;
+            case 'p' :
+                job.population = atoi(optarg);
+                break;
+            case 'n' :
+                job.games = atoi(optarg);
+                break;
+            case 'm' :
+                job.max_blocks = atoi(optarg);
+                break;
+            case 'r' :
+                if (0 > (job.randomizer = randomizer_by_name(optarg)))
+                {
+                    _usage();
+                    exit(-1);
+                }
+
+                break;
+            case 'j' :
+                threads = atoi(optarg);
+                break;
+            case 's' :
+                seed = strtoull(optarg, NULL, 10);
+                break;
+            case 'c' :
+                checkpoint = optarg;
+                break;
+            case 'h' :
+            default :
+                _usage();
+                exit(('h' == c) ? 0 : -1);
+                break;
+        }
+    }
+
+    if (job.population < 4 || job.population > TUNE_MAX_POPULATION || job.games < 1 || threads < 1)
+    {
+        _usage();
+        exit(-1);
+    }
+
+    board_init();
+    memset(&st, 0, sizeof(struct tune_state_t));
+    if (0 == _load(checkpoint, &st))
+    {
+        // Candidates are only comparable on the game sets the run started with
+        seed = st.seed;
+        job.population = st.population;
+        job.games = st.games;
+        job.max_blocks = st.max_blocks;
+        job.randomizer = st.randomizer;
+        printf("Resume from %s, generation %d, seed %llu, population %d, %d games of %d blocks\n",
+               checkpoint, st.generation, (unsigned long long int)seed, job.population, job.games, job.max_blocks);
+    }
+    else
+    {
+        memset(&st, 0, sizeof(struct tune_state_t));
+        const float init[TUNE_FEATURES] = {
+            bot_default_weights.height,
+            bot_default_weights.holes,
+            bot_default_weights.bumpiness,
+            bot_default_weights.lines
+        };
+
+        rng_seed(&st.rng, seed);
+        st.seed = seed;
+        st.population = job.population;
+        st.games = job.games;
+        st.max_blocks = job.max_blocks;
+        st.randomizer = job.randomizer;
+        for (k = 0; k < TUNE_FEATURES; k ++)
+        {
+            st.mean[k] = st.best[k] = init[k];
+            st.sigma[k] = 0.5f;
+        }
+
+        st.best_fitness = -1;
+    }
+
+    job.lines = malloc(sizeof(int) * job.population * job.games);
+    pthread_t *workers = malloc(sizeof(pthread_t) * threads);
+    if (job.lines == NULL || workers == NULL)
+    {
+        perror("malloc");
+        exit(-1);
+    }
+
+    int elite = job.population / 4;
+    for (; st.generation < generations; st.generation ++)
+    {
+        struct timespec begin, end;
+        float v[TUNE_FEATURES];
+        for (i = 0; i < job.population; i ++)
+        {
+            for (k = 0; k < TUNE_FEATURES; k ++)
+            {
+                v[k] = st.mean[k] + st.sigma[k] * _gaussian(&st.rng);
+            }
+
+            job.candidates[i] = _to_weights(v);
+        }
+
+        // Same sequences for every candidate of a generation, fresh ones next generation
+        job.seed = seed + (uint64_t)st.generation * job.games + 1;
+        job.next = 0;
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        for (i = 0; i < threads; i ++)
+        {
+            pthread_create(&workers[i], NULL, _worker, &job);
+        }
+
+        for (i = 0; i < threads; i ++)
+        {
+            pthread_join(workers[i], NULL);
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double elapsed = (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) / 1e9;
+
+        for (i = 0; i < job.population; i ++)
+        {
+            long long int sum = 0;
+            int g;
+            for (g = 0; g < job.games; g ++)
+            {
+                sum += job.lines[i * job.games + g];
+            }
+
+            ranked[i][0] = (double)sum / job.games;
+            ranked[i][1] = job.candidates[i].height;
+            ranked[i][2] = job.candidates[i].holes;
+            ranked[i][3] = job.candidates[i].bumpiness;
+            ranked[i][4] = job.candidates[i].lines;
+        }
+
+        qsort(ranked, job.population, sizeof(ranked[0]), _cmp_fitness);
+        if (ranked[0][0] > st.best_fitness)
+        {
+            st.best_fitness = ranked[0][0];
+            for (k = 0; k < TUNE_FEATURES; k ++)
+            {
+                st.best[k] = ranked[0][1 + k];
+            }
+        }
+
+        // Refit to elite, decaying extra noise keeps the search from collapsing early
+        for (k = 0; k < TUNE_FEATURES; k ++)
+        {
+            double mean = 0, var = 0;
+            for (i = 0; i < elite; i ++)
+            {
+                mean += ranked[i][1 + k];
+            }
+
+            mean /= elite;
+            for (i = 0; i < elite; i ++)
+            {
+                var += (ranked[i][1 + k] - mean) * (ranked[i][1 + k] - mean);
+            }
+
+            st.mean[k] = mean;
+            st.sigma[k] = sqrt(var / elite + 0.05 / (st.generation + 1));
+        }
+
+        printf("gen %3d : best %.2f lines, elite cut %.2f, %.0f games/sec, weights %.4f %.4f %.4f %.4f\n",
+            st.generation,
+            ranked[0][0],
+            ranked[elite - 1][0],
+            elapsed > 0 ? job.population * job.games / elapsed : 0,
+            st.mean[0], st.mean[1], st.mean[2], st.mean[3]);
+        fflush(stdout);
+
+        // Checkpoint resumes at the following generation
+        struct tune_state_t snap = st;
+        snap.generation ++;
+        if (0 != _save(checkpoint, &snap))
+        {
+            perror("checkpoint");
+        }
+    }
+
+    printf("best %.2f lines, weights %.6f %.6f %.6f %.6f\n",
+        st.best_fitness, st.best[0], st.best[1], st.best[2], st.best[3]);
+
+    free(workers);
+    free(job.lines);
+
+    return 0;
+}
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
@@ -0,0 +1,237 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file verify.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ */
+
+#include <dirent.h>
+#include <pthread.h>
+#include "../src/tetris.h"
+
+/*
+ * Replays every recording of a directory with the current engine. Files
+ * are mapped, never read into buffers, and handed to workers one at a
+ * time through an atomic cursor so a few long games do not stall a
+ * statically split batch.
+ */
+struct verify_job_t
+{
+    char              **files;
+    int                 total;
+    int                 next;
+    int                 passed;
+    int                 failed;
+    int                 broken;
+    unsigned long long int
+                        blocks;
+    unsigned long long int
+                        ticks;
+};
+
+static void _usage()
+{
+    printf("Usage : tetris-verify [options] <dir>\n");
+    printf("\t-j <n> : Worker threads, default all cores\n");
+    printf("\t-q : Only print mismatches\n");
+    printf("\t-h : Show this help\n\n");
+
+    return;
+}
+
+static bool quiet = FALSE;
+
+static void * _worker(void *arg)
+{
+    struct verify_job_t *job = arg;
+    struct tetris_scene_t s;
+    struct replay_t *r;
+    int i, k;
+
+    while ((i = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED)) < job->total)
+    {
+        if (NULL == (r = replay_open(job->files[i])))
+        {
+            printf("BROKEN %s\n", job->files[i]);
+            __atomic_fetch_add(&job->broken, 1, __ATOMIC_RELAXED);
+
+            continue;
+        }
+
+        k = replay_verify(r, &s);
+        if (k != 0)
+        {
+            printf("MISMATCH %s : keyframe %d, piece %d, score %d\n", job->files[i], k, s.blocks, (int)s.score);
+            __atomic_fetch_add(&job->failed, 1, __ATOMIC_RELAXED);
+        }
+        else
+        {
+            if (!quiet)
+            {
+                printf("OK %s : %d pieces, score %d\n", job->files[i], s.blocks, (int)s.score);
+            }
+
+            __atomic_fetch_add(&job->passed, 1, __ATOMIC_RELAXED);
+        }
+
+        __atomic_fetch_add(&job->blocks, s.blocks, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&job->ticks, s.timer_counter, __ATOMIC_RELAXED);
+        replay_close(r);
+    }
+
+    return NULL;
+}
+
+static int _collect(const char *dir, struct verify_job_t *job)
+{
+    struct dirent *ent;
+    int capacity = 0;
+    DIR *d = opendir(dir);
+
+    if (d == NULL)
+    {
+        return -1;
+    }
+
+    while (NULL != (ent = readdir(d)))
+    {
+        if ('.' == ent->d_name[0] || (DT_REG != ent->d_type && DT_UNKNOWN != ent->d_type))
+        {
+            continue;
+        }
+
+        if (job->total == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 1024;
+            char **files = realloc(job->files, sizeof(char *) * capacity);
+            if (files == NULL)
+            {
+                closedir(d);
+
+                return -1;
+            }
+
+            job->files = files;
+        }
+
+        size_t len = strlen(dir) + strlen(ent->d_name) + 2;
+        if (NULL == (job->files[job->total] = malloc(len)))
+        {
+            closedir(d);
+
+            return -1;
+        }
+
+        snprintf(job->files[job->total ++], len, "%s/%s", dir, ent->d_name);
+    }
+
+    closedir(d);
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    static struct verify_job_t job;
+    struct timespec begin, end;
+    int threads = sysconf(_SC_NPROCESSORS_ONLN);
+    int c, i;
+
+    while (-1 != (c = getopt(argc, argv, "j:qh")))
+    {
+        switch (c)
+        {
+            case 'j' :
+                threads = atoi(optarg);
+                break;
+            case 'q' :
+                quiet = TRUE;
+                break;
+            case 'h' :
+            default :
+                _usage();
+                exit(('h' == c) ? 0 : -1);
+                break;
+        }
+    }
+
+    if (optind >= argc || threads < 1)
+    {
+        _usage();
+        exit(-1);
+    }
+
+    if (0 != _collect(argv[optind], &job))
+    {
+        perror(argv[optind]);
+        exit(-1);
+    }
+
+    pthread_t *workers = malloc(sizeof(pthread_t) * threads);
+    if (workers == NULL)
+    {
+        perror("malloc");
+        exit(-1);
+    }
+
+    board_init();
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (i = 0; i < threads; i ++)
+    {
+        pthread_create(&workers[i], NULL, _worker, &job);
+    }
+
+    for (i = 0; i < threads; i ++)
+    {
+        pthread_join(workers[i], NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed = (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) / 1e9;
+
+    printf("\n%d files : %d ok, %d mismatched, %d unreadable\n", job.total, job.passed, job.failed, job.broken);
+    printf("%llu pieces, %llu ticks in %.2fs : %.0f files/s, %.0f pieces/s on %d threads\n",
+           job.blocks, job.ticks, elapsed, job.total / elapsed, job.blocks / elapsed, threads);
+
+    for (i = 0; i < job.total; i ++)
+    {
+        free(job.files[i]);
+    }
+
+    free(job.files);
+    free(workers);
+
+    return (job.failed || job.broken) ? 1 : 0;
+}
+
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */
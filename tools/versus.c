@@ -0,0 +1,221 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2021 HereweTech Co.LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file versus.c
+ * @author Dr.NP <conan.np@gmail.com>
+ * @since 10/18/2026
+ */
+
+#include <pthread.h>
+#include "../src/tetris.h"
+
+/*
+ * Head to head matches between two weight sets of the built-in bot. Match
+ * i is played on seed + i, workers take matches through an atomic cursor.
+ */
+struct versus_job_t
+{
+    struct eval_weights_t
+                        weights[2];
+    struct game_config_t
+                        config;
+    int                 attack[5];
+    int                 matches;
+    int                 max_turns;
+    int                 next;
+    int                 wins[3];
+    unsigned long long int
+                        turns;
+};
+
+static void _usage()
+{
+    printf("%s versus - %s\n\n", APP_NAME, APP_VERSION);
+    printf("Play two bots against each other, lines cleared send garbage rows\n\n");
+    printf("\t-a <h,holes,bump,lines> : Weights of bot A, default built-in\n");
+    printf("\t-b <h,holes,bump,lines> : Weights of bot B, default built-in\n");
+    printf("\t-t <a1,a2,a3,a4> : Rows sent for 1 - 4 lines, default <0,1,2,4>\n");
+    printf("\t-n <n> : Matches, default <1000>\n");
+    printf("\t-m <n> : Turns before a match is drawn, default <1000>\n");
+    printf("\t-r <uniform|bag|history> : Block generator, default <uniform>\n");
+    printf("\t-j <n> : Worker threads, default all cores\n");
+    printf("\t-s <seed> : Seed of the first match\n");
+    printf("\t-h : Print this topic\n");
+
+    return;
+}
+
+static int _parse(const char *arg, float *v, int n)
+{
+    char *end;
+    int i;
+    for (i = 0; i < n; i ++)
+    {
+        v[i] = strtof(arg, &end);
+        if (end == arg || (i < n - 1 && ',' != *end))
+        {
+            return -1;
+        }
+
+        arg = end + 1;
+    }
+
+    return 0;
+}
+
+static void * _worker(void *arg)
+{
+    struct versus_job_t *job = arg;
+    struct game_config_t config = job->config;
+    struct versus_t v;
+    int i;
+
+    while ((i = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED)) < job->matches)
+    {
+        config.seed = job->config.seed + i;
+        versus_init(&v, &config, job->attack);
+        versus_play(&v, &job->weights[0], &job->weights[1], job->max_turns);
+        __atomic_fetch_add(&job->wins[v.winner], 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&job->turns, v.turns, __ATOMIC_RELAXED);
+    }
+
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    static struct versus_job_t job;
+    struct timespec begin, end;
+    int threads = sysconf(_SC_NPROCESSORS_ONLN);
+    float v[4];
+    int c, i;
+
+    job.weights[0] = job.weights[1] = bot_default_weights;
+    memcpy(job.attack, (int [5]){0, 0, 1, 2, 4}, sizeof(job.attack));
+    job.matches = 1000;
+    job.max_turns = 1000;
+    game_config_default(&job.config);
+    job.config.seed = 1024;
+    while (-1 != (c = getopt(argc, argv, "a:b:t:n:m:r:j:s:h")))
+    {
+        switch (c)
+        {
+            case 'a' :
+            case 'b' :
+                if (0 != _parse(optarg, v, 4))
+                {
+                    _usage();
+                    exit(-1);
+                }
+
+                job.weights[c - 'a'] = (struct eval_weights_t){v[0], v[1], v[2], v[3]};
+                break;
+            case 't' :
+                if (0 != _parse(optarg, v, 4))
+                {
+                    _usage();
+                    exit(-1);
+                }
+
+                for (i = 0; i < 4; i ++)
+                {
+                    job.attack[i + 1] = v[i];
+                }
+
+                break;
+            case 'n' :
+                job.matches = atoi(optarg);
+                break;
+            case 'm' :
+                job.max_turns = atoi(optarg);
+                break;
+            case 'r' :
+                if (0 > (job.config.randomizer = randomizer_by_name(optarg)))
+                {
+                    _usage();
+                    exit(-1);
+                }
+
+                break;
+            case 'j' :
+                threads = atoi(optarg);
+                break;
+            case 's' :
+                job.config.seed = strtoull(optarg, NULL, 10);
+                break;
+            case 'h' :
+            default :
+                _usage();
+                exit(('h' == c) ? 0 : -1);
+                break;
+        }
+    }
+
+    if (job.matches < 1 || threads < 1)
+    {
+        _usage();
+        exit(-1);
+    }
+
+    pthread_t *workers = malloc(sizeof(pthread_t) * threads);
+    if (workers == NULL)
+    {
+        perror("malloc");
+        exit(-1);
+    }
+
+    board_init();
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (i = 0; i < threads; i ++)
+    {
+        pthread_create(&workers[i], NULL, _worker, &job);
+    }
+
+    for (i = 0; i < threads; i ++)
+    {
+        pthread_join(workers[i], NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed = (end.tv_sec - begin.tv_sec) + (end.tv_nsec - begin.tv_nsec) / 1e9;
+
+    printf("A %d / B %d / draw %d, A scores %.3f, %.1f turns per match\n",
+           job.wins[0], job.wins[1], job.wins[VERSUS_DRAW],
+           (job.wins[0] + 0.5 * job.wins[VERSUS_DRAW]) / job.matches, (double)job.turns / job.matches);
+    printf("%d matches in %.2fs : %.0f matches/s, %.0f per thread on %d threads\n",
+           job.matches, elapsed, job.matches / elapsed, job.matches / elapsed / threads, threads);
+    free(workers);
+
+    return 0;
+}
+
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: sw=4 ts=4 fdm=marker
+ * vim<600: sw=4 ts=4
+ */